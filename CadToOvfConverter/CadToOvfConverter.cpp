@@ -1,20 +1,130 @@
-// CadToOvfConverter.cpp : This file contains the 'main' function. Program execution begins and ends there.
+// CadToOvfConverter.cpp : Command line front end converting a STEP model into an OVF job.
 //
 
+#include "ConversionPipeline.h"
+
+#include <cstdlib>
+#include <exception>
 #include <iostream>
+#include <string>
 
-int main()
-{
-    std::cout << "Hello World!\n";
+namespace {
+
+    void PrintUsage(std::ostream& os) {
+        os << "Usage: CadToOvfConverter <input.step> <output.ovf> [options]\n"
+           << "\n"
+           << "Options:\n"
+           << "  --layer-height <mm>         Distance between slicing planes (default 0.05)\n"
+           << "  --threads <n>               Worker threads, 0 uses every logical processor (default 0)\n"
+           << "  --contour-tolerance <mm>    Largest gap closed when joining section edges (default 0.001)\n"
+           << "  --chordal-deflection <mm>   Largest distance between a curve and its polyline (default 0.1)\n"
+           << "  --angular-deflection <rad>  Largest turning angle between polyline segments, 0 disables (default 0)\n"
+           << "  --min-segment <mm>          Shortest polyline segment kept (default 0)\n"
+           << "  --snap <mm>                 Grid polyline points are snapped to, 0 disables (default 0)\n"
+           << "  --analytic-curves           Write lines, circles and ellipses as exact OVF geometry\n"
+           << "  --in-flight <n>             Layers between slicing and writing, 0 uses twice the thread count\n"
+           << "  --marking-params <key>      marking_params_key of every VectorBlock (default 0)\n"
+           << "  --write-buffer-mb <n>       Size of each output buffer in MiB (default 4)\n"
+           << "  --write-buffers <n>         Output buffers shared with the I/O thread (default 2)\n"
+           << "  --sync-io                   Write the output file on the worker threads\n"
+           << "  --dedup-layers              Write runs of identical layers once, with WorkPlane repeats\n";
+    }
+
+    // Parses the number following option i. Returns false if it is missing or malformed.
+    bool ParseNumber(int argc, char* argv[], int& i, double& value) {
+        if (i + 1 >= argc) {
+            return false;
+        }
+        char* end = nullptr;
+        value = std::strtod(argv[++i], &end);
+        return end != argv[i] && *end == '\0';
+    }
+
+    bool ParseArguments(int argc, char* argv[], converter::ConversionOptions& options) {
+        if (argc < 3) {
+            return false;
+        }
+        options.input_path = argv[1];
+        options.output_path = argv[2];
+        options.slice.thread_count = 0;
+
+        for (int i = 3; i < argc; ++i) {
+            const std::string arg = argv[i];
+            double value = 0.0;
+            if (arg == "--analytic-curves") {
+                options.slice.curve_emission = geometry::CurveEmission::Analytic;
+                continue;
+            }
+            if (arg == "--sync-io") {
+                options.writer.async_io = false;
+                continue;
+            }
+            if (arg == "--dedup-layers") {
+                options.writer.deduplicate_work_planes = true;
+                continue;
+            }
+            if (!ParseNumber(argc, argv, i, value)) {
+                std::cerr << "Missing or invalid value for " << arg << "\n";
+                return false;
+            }
+            if (arg == "--layer-height" && value > 0.0) {
+                options.slice.layer_height = value;
+            }
+            else if (arg == "--threads" && value >= 0.0) {
+                options.slice.thread_count = static_cast<int>(value);
+            }
+            else if (arg == "--contour-tolerance" && value > 0.0) {
+                options.slice.contour_tolerance = value;
+            }
+            else if (arg == "--chordal-deflection" && value > 0.0) {
+                options.slice.discretization.chordal_deflection = value;
+            }
+            else if (arg == "--angular-deflection" && value >= 0.0) {
+                options.slice.discretization.angular_deflection = value;
+            }
+            else if (arg == "--min-segment" && value >= 0.0) {
+                options.slice.discretization.min_segment_length = value;
+            }
+            else if (arg == "--snap" && value >= 0.0) {
+                options.slice.discretization.snap_resolution = value;
+            }
+            else if (arg == "--in-flight" && value >= 0.0) {
+                options.max_layers_in_flight = static_cast<int>(value);
+            }
+            else if (arg == "--marking-params") {
+                options.marking_params_key = static_cast<int32_t>(value);
+            }
+            else if (arg == "--write-buffer-mb" && value > 0.0) {
+                options.writer.buffer_size = static_cast<size_t>(value * 1024.0 * 1024.0);
+            }
+            else if (arg == "--write-buffers" && value >= 2.0) {
+                options.writer.buffer_count = static_cast<size_t>(value);
+            }
+            else {
+                std::cerr << "Unknown option or value out of range: " << arg << "\n";
+                return false;
+            }
+        }
+        return true;
+    }
 }
 
-// Run program: Ctrl + F5 or Debug > Start Without Debugging menu
-// Debug program: F5 or Debug > Start Debugging menu
+int main(int argc, char* argv[])
+{
+    converter::ConversionOptions options;
+    if (!ParseArguments(argc, argv, options)) {
+        PrintUsage(std::cerr);
+        return 1;
+    }
 
-// Tips for Getting Started: 
-//   1. Use the Solution Explorer window to add/manage files
-//   2. Use the Team Explorer window to connect to source control
-//   3. Use the Output window to see build output and other messages
-//   4. Use the Error List window to view errors
-//   5. Go to Project > Add New Item to create new code files, or Project > Add Existing Item to add existing code files to the project
-//   6. In the future, to open this project again, go to File > Open > Project and select the .sln file
+    try {
+        converter::ConversionPipeline pipeline(options);
+        pipeline.Run();
+        pipeline.PrintStats(std::cout);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Conversion failed: " << e.what() << "\n";
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,227 @@
+#include "ConversionPipeline.h"
+#include "ContourAssembler.h"
+#include "GeometryContract.h"
+#include "LayerConverter.h"
+#include "OvfWriter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <thread>
+
+namespace converter {
+
+    namespace {
+
+        enum Stage { kLoad, kSlice, kAssemble, kBuild, kWrite, kStageCount };
+        const char* const kStageNames[kStageCount] = {
+            "load", "slice", "contour assembly", "vectorblock build", "write"
+        };
+
+        typedef std::chrono::steady_clock Clock;
+
+        double SecondsSince(Clock::time_point start) {
+            return std::chrono::duration<double>(Clock::now() - start).count();
+        }
+
+        void Record(StageStats& stats, Clock::time_point start) {
+            ++stats.items;
+            stats.busy_seconds += SecondsSince(start);
+        }
+
+        // A layer between the build and the write stage.
+        struct LayerWork {
+            double z = 0.0;
+            open_vector_format::writer::WorkPlaneSegment segment; // The layer's VectorBlocks, serialized.
+        };
+
+        // Converts the layer's geometry into VectorBlocks and serializes them into the layer's segment.
+        void BuildSegment(const geometry_contract::SlicedLayer& layer, int32_t marking_params_key, LayerWork& work) {
+            open_vector_format::WorkPlane work_plane_shell;
+            work_plane_shell.set_z_pos_in_mm(work.z);
+            work.segment = open_vector_format::writer::WorkPlaneSegment(work_plane_shell);
+            open_vector_format::writer::AppendLayer(layer, marking_params_key, work.segment);
+        }
+    }
+
+    ConversionPipeline::ConversionPipeline(const ConversionOptions& options)
+        : m_options(options) {
+    }
+
+    void ConversionPipeline::Run() {
+
+        const auto run_start = Clock::now();
+        m_stats.assign(kStageCount, StageStats());
+        for (int stage = 0; stage < kStageCount; ++stage) {
+            m_stats[stage].name = kStageNames[stage];
+        }
+        m_layers_written = 0;
+
+        // --- Load: once, before any layer starts ---
+        auto start = Clock::now();
+        geometry::StepSlicer slicer(m_options.input_path);
+        if (!slicer.Load()) {
+            throw std::runtime_error("Failed to load STEP file: " + m_options.input_path);
+        }
+        const std::vector<double> heights = slicer.LayerHeights(m_options.slice.layer_height);
+        Record(m_stats[kLoad], start);
+
+        // The slice stage leaves contour assembly to its own stage.
+        geometry::SliceOptions slice_options = m_options.slice;
+        slice_options.assemble_contours = false;
+
+        const unsigned int hardware_threads = std::max(1u, std::thread::hardware_concurrency());
+        const size_t nb_workers = m_options.slice.thread_count > 0 ? static_cast<size_t>(m_options.slice.thread_count)
+                                                                   : hardware_threads;
+        const size_t window = m_options.max_layers_in_flight > 0 ? static_cast<size_t>(m_options.max_layers_in_flight)
+                                                                 : 2 * nb_workers;
+
+        open_vector_format::Job job_shell;
+        job_shell.mutable_job_meta_data()->set_job_name(m_options.input_path);
+        // Every block belongs to part 0. Its layer thickness tells readers how far apart the
+        // repeats of a deduplicated layer are.
+        open_vector_format::Part& part = (*job_shell.mutable_parts_map())[0];
+        part.set_name(m_options.input_path);
+        part.mutable_process_strategy()->set_layer_thickness_in_mm(static_cast<float>(m_options.slice.layer_height));
+
+        {
+            open_vector_format::writer::JobWriter job_writer(m_options.output_path, job_shell, m_options.writer);
+
+            std::mutex mutex;
+            std::condition_variable window_open;
+            size_t next_layer = 0;      // Next height handed to a worker.
+            size_t next_to_write = 0;   // Next height the write stage expects.
+            bool writing = false;       // A worker is currently draining finished layers.
+            std::exception_ptr failure;
+            // Layers in flight always lie in [next_to_write, next_to_write + window), so each owns a slot.
+            std::vector<LayerWork> finished(window);
+            std::vector<bool> is_finished(window, false);
+
+            auto worker = [&]() {
+                StageStats local[kStageCount];
+                try {
+                    for (;;) {
+                        size_t index;
+                        {
+                            std::unique_lock<std::mutex> lock(mutex);
+                            window_open.wait(lock, [&] {
+                                return failure || next_layer >= heights.size() || next_layer < next_to_write + window;
+                            });
+                            if (failure || next_layer >= heights.size()) {
+                                break;
+                            }
+                            index = next_layer++;
+                        }
+
+                        LayerWork work;
+                        work.z = heights[index];
+
+                        auto stage_start = Clock::now();
+                        geometry_contract::SlicedLayer layer = slicer.SliceLayer(work.z, slice_options);
+                        Record(local[kSlice], stage_start);
+
+                        stage_start = Clock::now();
+                        if (m_options.slice.assemble_contours) {
+                            geometry::ContourAssembler assembler(m_options.slice.contour_tolerance);
+                            layer.contours = assembler.Assemble(std::move(layer.contours));
+                        }
+                        Record(local[kAssemble], stage_start);
+
+                        stage_start = Clock::now();
+                        BuildSegment(layer, m_options.marking_params_key, work);
+                        Record(local[kBuild], stage_start);
+
+                        // Park the layer, then drain every layer that is next in Z order, unless
+                        // another worker is already doing so and will pick this one up.
+                        std::unique_lock<std::mutex> lock(mutex);
+                        finished[index % window] = std::move(work);
+                        is_finished[index % window] = true;
+                        if (writing) {
+                            continue;
+                        }
+                        writing = true;
+                        while (!failure && next_to_write < heights.size() && is_finished[next_to_write % window]) {
+                            LayerWork ready = std::move(finished[next_to_write % window]);
+                            is_finished[next_to_write % window] = false;
+                            lock.unlock();
+
+                            stage_start = Clock::now();
+                            if (!ready.segment.IsEmpty()) {
+                                // Only the draining worker touches m_layers_written, which numbers the work planes.
+                                job_writer.CommitWorkPlane(static_cast<int32_t>(m_layers_written), std::move(ready.segment));
+                                ++m_layers_written;
+                            }
+                            Record(local[kWrite], stage_start);
+
+                            lock.lock();
+                            ++next_to_write;
+                            window_open.notify_all();
+                        }
+                        writing = false;
+                    }
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!failure) {
+                        failure = std::current_exception();
+                    }
+                    writing = false;
+                    window_open.notify_all();
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                for (int stage = kSlice; stage < kStageCount; ++stage) {
+                    m_stats[stage].items += local[stage].items;
+                    m_stats[stage].busy_seconds += local[stage].busy_seconds;
+                }
+            };
+
+            std::vector<std::thread> workers;
+            for (size_t i = 0; i < nb_workers; ++i) {
+                workers.emplace_back(worker);
+            }
+            for (auto& thread : workers) {
+                thread.join();
+            }
+            if (failure) {
+                std::rethrow_exception(failure);
+            }
+
+            // Writes the job shell and LUT, waits for the I/O thread and reports any write error.
+            start = Clock::now();
+            job_writer.Close();
+            m_stats[kWrite].busy_seconds += SecondsSince(start);
+        }
+
+        std::ifstream output(m_options.output_path, std::ios::binary | std::ios::ate);
+        m_bytes_written = output ? static_cast<uint64_t>(output.tellg()) : 0;
+        m_wall_seconds = SecondsSince(run_start);
+    }
+
+    void ConversionPipeline::PrintStats(std::ostream& os) const {
+        os << std::left << std::setw(20) << "stage" << std::right
+           << std::setw(10) << "items" << std::setw(12) << "busy [s]" << std::setw(14) << "items/s" << "\n";
+        for (const auto& stage : m_stats) {
+            const double rate = stage.busy_seconds > 0.0 ? stage.items / stage.busy_seconds : 0.0;
+            os << std::left << std::setw(20) << stage.name << std::right
+               << std::setw(10) << stage.items
+               << std::setw(12) << std::fixed << std::setprecision(3) << stage.busy_seconds
+               << std::setw(14) << std::setprecision(1) << rate << "\n";
+        }
+        const double megabytes = m_bytes_written / (1024.0 * 1024.0);
+        os << std::fixed << std::setprecision(3)
+           << "wall time " << m_wall_seconds << " s, " << m_layers_written << " layers, "
+           << megabytes << " MB written";
+        if (m_wall_seconds > 0.0) {
+            os << " (" << std::setprecision(1) << m_layers_written / m_wall_seconds << " layers/s, "
+               << std::setprecision(2) << megabytes / m_wall_seconds << " MB/s)";
+        }
+        os << "\n";
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "OvfWriter.h"
+#include "StepSlicer.h"
+
+namespace converter {
+
+    struct ConversionOptions {
+        std::string input_path;
+        std::string output_path;
+        // Layer height, thread count, tolerances and discretization. thread_count sizes the
+        // pipeline's worker pool; the engine is always the section engine.
+        geometry::SliceOptions slice;
+        // Maximum number of layers between being sliced and being written. 0 uses twice
+        // the worker count. This bounds the memory of the whole conversion.
+        int max_layers_in_flight = 0;
+        // Key into the job's marking_params_map used for every VectorBlock.
+        int32_t marking_params_key = 0;
+        // Buffering of the output file. The pipeline writes on its own I/O thread unless
+        // async_io is switched off.
+        open_vector_format::writer::JobWriterOptions writer = DefaultWriterOptions();
+
+        static open_vector_format::writer::JobWriterOptions DefaultWriterOptions() {
+            open_vector_format::writer::JobWriterOptions options;
+            options.async_io = true;
+            return options;
+        }
+    };
+
+    // Work done by one pipeline stage over a whole conversion.
+    struct StageStats {
+        std::string name;
+        size_t items = 0;
+        double busy_seconds = 0.0; // Summed over all threads running the stage.
+    };
+
+    /**
+     * @brief Converts a STEP file into an OVF job through a bounded, pipelined stage graph.
+     *
+     * The model is loaded once. Every layer then flows through
+     * slice -> contour assembly -> VectorBlock build and serialization -> write.
+     * The first three stages run on any worker thread, several layers at a time; each
+     * layer is serialized into its own WorkPlaneSegment. The write stage commits the
+     * segments in Z order on whichever worker finishes the next layer to write, so
+     * slicing, serialization and file I/O overlap. At most max_layers_in_flight layers exist at
+     * once; a worker that would exceed it waits for the writer to catch up.
+     */
+    class ConversionPipeline {
+    public:
+        explicit ConversionPipeline(const ConversionOptions& options);
+
+        /**
+         * @brief Runs the conversion.
+         * @throws std::runtime_error if the input cannot be loaded or the output written.
+         *         An exception thrown by a stage stops all workers and is rethrown here.
+         */
+        void Run();
+
+        size_t LayersWritten() const { return m_layers_written; }
+        const std::vector<StageStats>& Stats() const { return m_stats; }
+
+        // Prints items, busy time and throughput of every stage, and the total wall time.
+        void PrintStats(std::ostream& os) const;
+
+    private:
+        ConversionOptions m_options;
+        std::vector<StageStats> m_stats;
+        size_t m_layers_written = 0;
+        double m_wall_seconds = 0.0;
+        uint64_t m_bytes_written = 0;
+    };
+}
@@ -2,15 +2,24 @@
 #include "CppUnitTest.h"
 
 #include "OvfWriter.h"
+#include "OvfReader.h"
+#include "OvfUtil.h"
+#include "LayerConverter.h"
 #include "open_vector_format.pb.h"
 #include "ovf_lut.pb.h"
 #include "TestFixtures.h"
+#include "google/protobuf/io/coded_stream.h"
 
+#include <cmath>
 #include <fstream>
+#include <iterator>
 #include <string>
+#include <thread>
+#include <vector>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 using namespace open_vector_format::writer;
+using namespace open_vector_format::reader;
 using namespace open_vector_format;
 
 namespace CadToOvfConverterTests
@@ -253,5 +262,846 @@ namespace CadToOvfConverterTests
 				Assert::AreEqual(original_vb_2.SerializeAsString(), read_vb_2.SerializeAsString(), L"WP2 VectorBlock does not match.");
 			}
 		}
+
+		TEST_METHOD(SetLineSequence_FlatLayerContours_MatchHandBuiltBlocks)
+		{
+			// ARRANGE
+			geometry_contract::SlicedLayer layer;
+			layer.ZHeight = 0.05;
+			geometry_contract::Contour square;
+			square.points = { { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 }, { 0, 0 } };
+			square.closed = true;
+			geometry_contract::Contour triangle;
+			triangle.points = { { 0, 0 }, { 5, 10 }, { 10, 0 }, { 0, 0 } };
+			triangle.closed = true;
+			layer.contours = { square, triangle };
+
+			geometry_contract::FlatLayer flat;
+			VectorBlock block;
+			std::string first, second;
+
+			// ACT
+			geometry_contract::Flatten(layer, flat);
+			util::SetLineSequence(flat, 0, block);
+			first = block.SerializeAsString();
+			util::SetLineSequence(flat, 1, block); // The same block is reused for the next contour.
+			second = block.SerializeAsString();
+
+			// ASSERT
+			Assert::AreEqual(size_t(2), flat.ContourCount());
+			Assert::AreEqual(size_t(9), flat.PointCount());
+			Assert::IsTrue(flat.IsClosed(0) && flat.IsClosed(1));
+			Assert::AreEqual(TestFixtures::CreateSquareVectorBlock().SerializeAsString(), first, L"Square block differs.");
+			Assert::AreEqual(TestFixtures::CreateTriangleVectorBlock().SerializeAsString(), second, L"Triangle block differs.");
+		}
+
+		TEST_METHOD(ContourToVectorBlock_NarrowsPointsAndMeasuresBlock)
+		{
+			// ARRANGE
+			// An odd point count, so both the vectorized loop and the scalar tail take part.
+			geometry_contract::Contour contour;
+			double expected_length = 0.0;
+			for (int i = 0; i < 11; ++i) {
+				contour.points.push_back({ 0.1 * i * i, std::sin(0.7 * i) });
+				if (i > 0) {
+					const auto& a = contour.points[i - 1];
+					const auto& b = contour.points[i];
+					expected_length += std::hypot(b.x - a.x, b.y - a.y);
+				}
+			}
+			VectorBlock block;
+
+			// ACT
+			ContourToVectorBlock(contour, block);
+
+			// ASSERT
+			const auto& points = block.line_sequence().points();
+			Assert::AreEqual(22, points.size());
+			for (int i = 0; i < 11; ++i) {
+				Assert::AreEqual(static_cast<float>(contour.points[i].x), points.Get(2 * i), L"X was not narrowed in place.");
+				Assert::AreEqual(static_cast<float>(contour.points[i].y), points.Get(2 * i + 1), L"Y was not narrowed in place.");
+			}
+			const auto& bounds = block.meta_data().bounds();
+			Assert::AreEqual(0.0f, bounds.x_min());
+			Assert::AreEqual(10.0f, bounds.x_max());
+			Assert::AreEqual(static_cast<float>(std::sin(0.7 * 9)), bounds.y_min(), 1e-6f);
+			Assert::AreEqual(static_cast<float>(std::sin(0.7 * 2)), bounds.y_max(), 1e-6f);
+			Assert::AreEqual(expected_length, block.meta_data().total_scan_distance_in_mm(), 1e-9);
+		}
+
+		TEST_METHOD(ArcToVectorBlock_QuarterArc_HasExactBoundsAndLength)
+		{
+			// ARRANGE
+			geometry_contract::Arc arc;
+			arc.center = { 1.0, 2.0 };
+			arc.start = { 4.0, 2.0 };
+			arc.angle = 90.0; // Counter-clockwise from (4, 2) to (1, 5).
+			VectorBlock block;
+
+			// ACT
+			ArcToVectorBlock(arc, block);
+
+			// ASSERT
+			Assert::IsTrue(block.has__arcs(), L"The block should hold an Arcs message.");
+			Assert::AreEqual(90.0, block._arcs().angle());
+			Assert::AreEqual(3.0f, block._arcs().start_dx());
+			Assert::AreEqual(0.0f, block._arcs().start_dy());
+			Assert::AreEqual(2, block._arcs().centers_size());
+			const auto& bounds = block.meta_data().bounds();
+			Assert::AreEqual(1.0f, bounds.x_min(), 1e-6f);
+			Assert::AreEqual(2.0f, bounds.y_min(), 1e-6f);
+			Assert::AreEqual(4.0f, bounds.x_max(), 1e-6f);
+			Assert::AreEqual(5.0f, bounds.y_max(), 1e-6f);
+			Assert::AreEqual(1.5 * 3.14159265358979323846, block.meta_data().total_scan_distance_in_mm(), 1e-9);
+		}
+
+		TEST_METHOD(JobWriter_BufferSize_DoesNotChangeFileContent)
+		{
+			// ARRANGE
+			// A block larger than the smallest buffer, so records straddle buffer boundaries.
+			VectorBlock large_vb;
+			for (int i = 0; i < 4000; ++i) {
+				large_vb.mutable_line_sequence()->add_points(static_cast<float>(i));
+			}
+			Job job_shell;
+			job_shell.mutable_job_meta_data()->set_job_name("BufferJob");
+			JobWriterOptions small_buffer;
+			small_buffer.buffer_size = 1; // Clamped to the smallest supported buffer.
+
+			auto write_job = [&](const std::string& path, const JobWriterOptions& options) {
+				JobWriter writer(path, job_shell, options);
+				for (int layer = 0; layer < 3; ++layer) {
+					WorkPlane wp_shell;
+					wp_shell.set_z_pos_in_mm(0.05 * layer);
+					WorkPlaneWriter wp_writer = writer.AppendWorkPlane(wp_shell);
+					wp_writer.AppendVectorBlock(TestFixtures::CreateSquareVectorBlock());
+					wp_writer.AppendVectorBlock(large_vb);
+				}
+			};
+			auto read_file = [](const std::string& path) {
+				std::ifstream fs(path, std::ios::binary);
+				return std::string(std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>());
+			};
+
+			// ACT
+			write_job("test_buffer_small.ovf", small_buffer);
+			write_job("test_buffer_default.ovf", JobWriterOptions());
+
+			// ASSERT
+			const std::string small = read_file("test_buffer_small.ovf");
+			const std::string large = read_file("test_buffer_default.ovf");
+			Assert::IsTrue(small.size() > 3 * 16000, L"The file is missing the large blocks.");
+			Assert::IsTrue(small == large, L"The buffer size must not change the written bytes.");
+
+			uint64_t job_lut_offset;
+			std::ifstream fs("test_buffer_small.ovf", std::ios::binary);
+			fs.seekg(4);
+			TestFixtures::ReadLittleEndian(fs, job_lut_offset);
+			JobLUT read_job_lut;
+			Assert::IsTrue(TestFixtures::ReadDelimitedFromOffset("test_buffer_small.ovf", job_lut_offset, read_job_lut), L"Failed to parse JobLUT.");
+			Assert::AreEqual(3, read_job_lut.workplanepositions_size());
+		}
+
+		TEST_METHOD(JobWriter_DeferredOffsetPatches_MatchImmediatePatches)
+		{
+			// ARRANGE
+			Job job_shell;
+			job_shell.mutable_job_meta_data()->set_job_name("PatchJob");
+			JobWriterOptions deferred;
+			deferred.defer_offset_patches = true;
+			JobWriterOptions immediate;
+			immediate.defer_offset_patches = false;
+
+			auto write_job = [&](const std::string& path, const JobWriterOptions& options) {
+				JobWriter writer(path, job_shell, options);
+				for (int layer = 0; layer < 5; ++layer) {
+					WorkPlane wp_shell;
+					wp_shell.set_z_pos_in_mm(0.05 * layer);
+					WorkPlaneWriter wp_writer = writer.AppendWorkPlane(wp_shell);
+					wp_writer.AppendVectorBlock(TestFixtures::CreateSquareVectorBlock());
+				}
+			};
+			auto read_file = [](const std::string& path) {
+				std::ifstream fs(path, std::ios::binary);
+				return std::string(std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>());
+			};
+
+			// ACT
+			write_job("test_patch_deferred.ovf", deferred);
+			write_job("test_patch_immediate.ovf", immediate);
+
+			// ASSERT
+			Assert::IsTrue(read_file("test_patch_deferred.ovf") == read_file("test_patch_immediate.ovf"),
+				L"Deferring the offset patches must not change the written bytes.");
+
+			uint64_t job_lut_offset;
+			{
+				std::ifstream fs("test_patch_deferred.ovf", std::ios::binary);
+				fs.seekg(4);
+				TestFixtures::ReadLittleEndian(fs, job_lut_offset);
+			}
+			JobLUT read_job_lut;
+			Assert::IsTrue(TestFixtures::ReadDelimitedFromOffset("test_patch_deferred.ovf", job_lut_offset, read_job_lut), L"Failed to parse JobLUT.");
+			for (int i = 0; i < read_job_lut.workplanepositions_size(); ++i) {
+				uint64_t wp_lut_offset = 0;
+				std::ifstream fs("test_patch_deferred.ovf", std::ios::binary);
+				fs.seekg(read_job_lut.workplanepositions(i));
+				TestFixtures::ReadLittleEndian(fs, wp_lut_offset);
+				WorkPlaneLUT read_wp_lut;
+				Assert::IsTrue(TestFixtures::ReadDelimitedFromOffset("test_patch_deferred.ovf", wp_lut_offset, read_wp_lut), L"A WorkPlaneLUT offset was not patched.");
+				Assert::AreEqual(1, read_wp_lut.vectorblockspositions_size());
+			}
+		}
+
+		TEST_METHOD(JobWriter_AsyncIo_MatchesSynchronousOutput)
+		{
+			// ARRANGE
+			// Smallest buffers and only two of them, so the writer keeps waiting for the I/O thread.
+			VectorBlock large_vb;
+			for (int i = 0; i < 4000; ++i) {
+				large_vb.mutable_line_sequence()->add_points(static_cast<float>(i));
+			}
+			Job job_shell;
+			job_shell.mutable_job_meta_data()->set_job_name("AsyncJob");
+			JobWriterOptions sync_options;
+			sync_options.buffer_size = 1;
+			JobWriterOptions async_options = sync_options;
+			async_options.async_io = true;
+			async_options.buffer_count = 2;
+			JobWriterOptions async_immediate = async_options;
+			async_immediate.defer_offset_patches = false; // Patching has to wait for the I/O thread.
+
+			auto write_job = [&](const std::string& path, const JobWriterOptions& options) {
+				JobWriter writer(path, job_shell, options);
+				for (int layer = 0; layer < 8; ++layer) {
+					WorkPlane wp_shell;
+					wp_shell.set_z_pos_in_mm(0.05 * layer);
+					WorkPlaneWriter wp_writer = writer.AppendWorkPlane(wp_shell);
+					wp_writer.AppendVectorBlock(TestFixtures::CreateSquareVectorBlock());
+					wp_writer.AppendVectorBlock(large_vb);
+				}
+				writer.Close();
+			};
+			auto read_file = [](const std::string& path) {
+				std::ifstream fs(path, std::ios::binary);
+				return std::string(std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>());
+			};
+
+			// ACT
+			write_job("test_async_sync.ovf", sync_options);
+			write_job("test_async_deferred.ovf", async_options);
+			write_job("test_async_immediate.ovf", async_immediate);
+
+			// ASSERT
+			const std::string expected = read_file("test_async_sync.ovf");
+			Assert::IsTrue(expected.size() > 8 * 16000, L"The file is missing the large blocks.");
+			Assert::IsTrue(read_file("test_async_deferred.ovf") == expected, L"The I/O thread must not change the written bytes.");
+			Assert::IsTrue(read_file("test_async_immediate.ovf") == expected, L"Immediate patches must see every buffered byte.");
+
+			uint64_t job_lut_offset;
+			{
+				std::ifstream fs("test_async_deferred.ovf", std::ios::binary);
+				fs.seekg(4);
+				TestFixtures::ReadLittleEndian(fs, job_lut_offset);
+			}
+			JobLUT read_job_lut;
+			Assert::IsTrue(TestFixtures::ReadDelimitedFromOffset("test_async_deferred.ovf", job_lut_offset, read_job_lut), L"Failed to parse JobLUT.");
+			Assert::AreEqual(8, read_job_lut.workplanepositions_size());
+		}
+
+		TEST_METHOD(WorkPlaneWriter_AppendVectorBlocks_MatchesSerialWriter)
+		{
+			// ARRANGE
+			// Blocks of very different sizes, like a hatch-heavy layer next to its contours.
+			std::vector<VectorBlock> blocks;
+			for (int b = 0; b < 40; ++b) {
+				VectorBlock vb;
+				for (int i = 0; i < (b % 7) * 900 + 2; ++i) {
+					vb.mutable__hatches()->add_points(static_cast<float>(b + i));
+				}
+				vb.set_marking_params_key(b);
+				blocks.push_back(vb);
+			}
+			Job job_shell;
+			job_shell.mutable_job_meta_data()->set_job_name("BatchJob");
+			JobWriterOptions parallel;
+			parallel.serialization_threads = 4;
+			parallel.parallel_serialization_min_bytes = 0;
+			// Smaller than the largest blocks, so batches are split across buffers and some
+			// blocks straddle two of them.
+			JobWriterOptions small_buffers = parallel;
+			small_buffers.buffer_size = 4096;
+
+			auto write_job = [&](const std::string& path, const JobWriterOptions& options, bool batch) {
+				JobWriter writer(path, job_shell, options);
+				for (int layer = 0; layer < 3; ++layer) {
+					WorkPlane wp_shell;
+					wp_shell.set_z_pos_in_mm(0.05 * layer);
+					WorkPlaneWriter wp_writer = writer.AppendWorkPlane(wp_shell);
+					wp_writer.AppendVectorBlock(TestFixtures::CreateSquareVectorBlock());
+					if (batch) {
+						wp_writer.AppendVectorBlocks(blocks);
+					}
+					else {
+						for (const auto& vb : blocks) {
+							wp_writer.AppendVectorBlock(vb);
+						}
+					}
+				}
+			};
+			auto read_file = [](const std::string& path) {
+				std::ifstream fs(path, std::ios::binary);
+				return std::string(std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>());
+			};
+
+			// ACT
+			write_job("test_batch_serial.ovf", JobWriterOptions(), false);
+			write_job("test_batch_parallel.ovf", parallel, true);
+			write_job("test_batch_small_buffers.ovf", small_buffers, true);
+
+			// ASSERT
+			const std::string expected = read_file("test_batch_serial.ovf");
+			Assert::IsTrue(read_file("test_batch_parallel.ovf") == expected, L"Batch serialization must not change the written bytes.");
+			Assert::IsTrue(read_file("test_batch_small_buffers.ovf") == expected, L"Splitting a batch across buffers changed the bytes.");
+		}
+
+		TEST_METHOD(JobWriter_CommitWorkPlane_OutOfOrderSegmentsMatchWorkPlaneWriter)
+		{
+			// ARRANGE
+			Job job_shell;
+			job_shell.mutable_job_meta_data()->set_job_name("SegmentJob");
+			const int nb_layers = 6;
+			auto make_shell = [](int layer) {
+				WorkPlane wp_shell;
+				wp_shell.set_z_pos_in_mm(0.05 * layer);
+				return wp_shell;
+			};
+			auto read_file = [](const std::string& path) {
+				std::ifstream fs(path, std::ios::binary);
+				return std::string(std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>());
+			};
+
+			// ACT
+			{
+				JobWriter writer("test_segments_expected.ovf", job_shell);
+				for (int layer = 0; layer < nb_layers; ++layer) {
+					WorkPlaneWriter wp_writer = writer.AppendWorkPlane(make_shell(layer));
+					for (int i = 0; i <= layer; ++i) {
+						wp_writer.AppendVectorBlock(i % 2 ? TestFixtures::CreateTriangleVectorBlock() : TestFixtures::CreateSquareVectorBlock());
+					}
+				}
+			}
+			{
+				JobWriter writer("test_segments.ovf", job_shell);
+				std::vector<std::thread> producers;
+				for (int layer = nb_layers - 1; layer >= 0; --layer) {
+					producers.emplace_back([&writer, &make_shell, layer] {
+						WorkPlaneSegment segment(make_shell(layer));
+						for (int i = 0; i <= layer; ++i) {
+							segment.AppendVectorBlock(i % 2 ? TestFixtures::CreateTriangleVectorBlock() : TestFixtures::CreateSquareVectorBlock());
+						}
+						writer.CommitWorkPlane(layer, std::move(segment));
+					});
+				}
+				for (auto& producer : producers) {
+					producer.join();
+				}
+				writer.Close();
+			}
+
+			// ASSERT
+			Assert::IsTrue(read_file("test_segments.ovf") == read_file("test_segments_expected.ovf"),
+				L"Relocated segments must match the WorkPlaneWriter output byte for byte.");
+		}
+
+		TEST_METHOD(LineSequenceEncoder_MatchesGeneratedSerialization)
+		{
+			// ARRANGE
+			// Edge cases of the wire format: empty points, negative varints, -0.0 and unset bounds.
+			const float points[] = { 0.0f, -0.0f, 1.5f, -2.25f, 1e30f, 3.0f };
+			struct Case {
+				size_t float_count;
+				RawBlockFields fields;
+			};
+			std::vector<Case> cases(6);
+			cases[1].float_count = 6;
+			cases[1].fields.marking_params_key = -1;
+			cases[2].float_count = 4;
+			cases[2].fields.laser_index = 2;
+			cases[2].fields.repeats = 1ull << 40;
+			cases[2].fields.has_meta_data = true;
+			cases[3].float_count = 6;
+			cases[3].fields.has_meta_data = true;
+			cases[3].fields.total_scan_distance_in_mm = -0.0;
+			cases[3].fields.contour_index = -7;
+			cases[3].fields.has_bounds = true;
+			cases[3].fields.x_min = -0.0f;
+			cases[3].fields.y_max = 4.0f;
+			cases[4].float_count = 2;
+			cases[4].fields.has_meta_data = true;
+			cases[4].fields.has_bounds = true;
+			cases[4].fields.display_color = 0x7fffffff;
+			cases[4].fields.part_key = 3;
+			cases[4].fields.patch_key = 300;
+			cases[4].fields.total_jump_distance_in_mm = 12.5;
+			cases[5].float_count = 6;
+			cases[5].fields.marking_params_key = 1 << 20;
+
+			for (size_t c = 0; c < cases.size(); ++c) {
+				const RawBlockFields& f = cases[c].fields;
+				VectorBlock vb;
+				auto* line_points = vb.mutable_line_sequence()->mutable_points();
+				for (size_t i = 0; i < cases[c].float_count; ++i) {
+					line_points->Add(points[i]);
+				}
+				vb.set_marking_params_key(f.marking_params_key);
+				vb.set_laser_index(f.laser_index);
+				vb.set_repeats(f.repeats);
+				if (f.has_meta_data) {
+					auto* meta = vb.mutable_meta_data();
+					meta->set_total_scan_distance_in_mm(f.total_scan_distance_in_mm);
+					meta->set_total_jump_distance_in_mm(f.total_jump_distance_in_mm);
+					meta->set_part_key(f.part_key);
+					meta->set_patch_key(f.patch_key);
+					meta->set_contour_index(f.contour_index);
+					meta->set_display_color(f.display_color);
+					if (f.has_bounds) {
+						meta->mutable_bounds()->set_x_min(f.x_min);
+						meta->mutable_bounds()->set_y_min(f.y_min);
+						meta->mutable_bounds()->set_x_max(f.x_max);
+						meta->mutable_bounds()->set_y_max(f.y_max);
+					}
+				}
+				const size_t size = vb.ByteSizeLong();
+				std::vector<uint8_t> expected(google::protobuf::io::CodedOutputStream::VarintSize32(static_cast<uint32_t>(size)) + size);
+				const uint64_t offset = 0;
+				util::SerializeDelimitedBatch(&vb, 1, &offset, expected.data(), nullptr);
+
+				// ACT
+				LineSequenceEncoder encoder;
+				encoder.Begin(f);
+				// Split the points over two spans to cover the span list.
+				const size_t first = cases[c].float_count / 2;
+				encoder.AppendPoints(points, first);
+				encoder.AppendPoints(points + first, cases[c].float_count - first);
+				std::vector<uint8_t> encoded;
+				encoder.WriteTo([&](const void* data, size_t size) {
+					const uint8_t* bytes = static_cast<const uint8_t*>(data);
+					encoded.insert(encoded.end(), bytes, bytes + size);
+				});
+
+				// ASSERT
+				Assert::AreEqual(vb.ByteSizeLong(), encoder.BlockSize(), L"The block size differs from ByteSizeLong.");
+				Assert::IsTrue(encoded == expected, L"The encoded record differs from the generated serialization.");
+			}
+		}
+
+		TEST_METHOD(WorkPlaneWriter_RawLineSequenceBlocks_MatchAppendVectorBlock)
+		{
+			// ARRANGE
+			geometry_contract::SlicedLayer layer;
+			layer.ZHeight = 0.05;
+			geometry_contract::Contour square;
+			square.closed = true;
+			square.points = { { 0.0, 0.0 }, { 10.0, 0.0 }, { 10.0, 10.0 }, { 0.0, 10.0 }, { 0.0, 0.0 } };
+			layer.contours.push_back(square);
+			layer.contours.push_back(geometry_contract::Contour()); // An empty contour keeps empty meta data.
+			geometry_contract::Arc arc;
+			arc.center = { 5.0, 5.0 };
+			arc.start = { 7.0, 5.0 };
+			arc.angle = 90.0;
+			layer.arcs.push_back(arc);
+			Job job_shell;
+			WorkPlane wp_shell;
+			wp_shell.set_z_pos_in_mm(layer.ZHeight);
+			auto read_file = [](const std::string& path) {
+				std::ifstream fs(path, std::ios::binary);
+				return std::string(std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>());
+			};
+
+			// ACT
+			{
+				// The message path: every piece becomes a VectorBlock first.
+				JobWriter writer("test_raw_expected.ovf", job_shell);
+				WorkPlaneWriter wp_writer = writer.AppendWorkPlane(wp_shell);
+				VectorBlock block;
+				block.set_marking_params_key(4);
+				for (const auto& contour : layer.contours) {
+					ContourToVectorBlock(contour, block);
+					wp_writer.AppendVectorBlock(block);
+				}
+				ArcToVectorBlock(arc, block);
+				wp_writer.AppendVectorBlock(block);
+			}
+			{
+				JobWriter writer("test_raw_writer.ovf", job_shell);
+				WorkPlaneWriter wp_writer = writer.AppendWorkPlane(wp_shell);
+				AppendLayer(layer, 4, wp_writer);
+			}
+			{
+				JobWriter writer("test_raw_segment.ovf", job_shell);
+				WorkPlaneSegment segment(wp_shell);
+				AppendLayer(layer, 4, segment);
+				writer.CommitWorkPlane(0, std::move(segment));
+			}
+
+			// ASSERT
+			const std::string expected = read_file("test_raw_expected.ovf");
+			Assert::IsTrue(read_file("test_raw_writer.ovf") == expected, L"Raw emission through a WorkPlaneWriter changed the bytes.");
+			Assert::IsTrue(read_file("test_raw_segment.ovf") == expected, L"Raw emission into a segment changed the bytes.");
+		}
+
+		TEST_METHOD(WorkPlaneWriter_OpenLineSequenceBlock_RejectsOtherBlocks)
+		{
+			// ARRANGE
+			const std::string filepath = "test_raw_open_block.ovf";
+			const float points[] = { 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f };
+			VectorBlock block = TestFixtures::CreateTriangleVectorBlock();
+			Job job_shell;
+
+			// ACT & ASSERT
+			{
+				JobWriter writer(filepath, job_shell);
+				{
+					WorkPlaneWriter wp_writer = writer.AppendWorkPlane(WorkPlane());
+					Assert::ExpectException<std::runtime_error>([&] { wp_writer.AppendPoints(points, 6); });
+					wp_writer.BeginLineSequenceBlock();
+					wp_writer.AppendPoints(points, 6);
+					Assert::ExpectException<std::runtime_error>([&] { wp_writer.BeginLineSequenceBlock(); });
+					Assert::ExpectException<std::runtime_error>([&] { wp_writer.AppendVectorBlock(block); });
+					Assert::ExpectException<std::runtime_error>([&] { wp_writer.AppendVectorBlocks(&block, 1); });
+					Assert::ExpectException<std::runtime_error>([&] { wp_writer.CreateVectorBlock(); });
+					wp_writer.EndLineSequenceBlock();
+				}
+				{
+					// Destroyed with a block open, which is dropped.
+					WorkPlaneWriter wp_writer = writer.AppendWorkPlane(WorkPlane());
+					wp_writer.BeginLineSequenceBlock();
+					wp_writer.AppendPoints(points, 6);
+				}
+
+				WorkPlaneSegment segment;
+				Assert::ExpectException<std::runtime_error>([&] { segment.AppendPoints(points, 6); });
+				segment.BeginLineSequenceBlock();
+				Assert::ExpectException<std::runtime_error>([&] { segment.AppendVectorBlock(block); });
+				Assert::ExpectException<std::runtime_error>([&] { writer.CommitWorkPlane(2, std::move(segment)); });
+			}
+			JobReader reader(filepath);
+			Assert::AreEqual(size_t(2), reader.WorkPlaneCount());
+			WorkPlane shell;
+			reader.OpenWorkPlane(0).ReadShell(shell);
+			Assert::AreEqual(1, shell.num_blocks());
+			reader.OpenWorkPlane(1).ReadShell(shell);
+			Assert::AreEqual(0, shell.num_blocks());
+		}
+
+		TEST_METHOD(WorkPlaneWriter_ArenaBlocks_MatchHeapBlocks)
+		{
+			// ARRANGE
+			Job job_shell;
+			JobWriterOptions small_arena;
+			small_arena.arena_block_size = 4096; // Overflows on the first workplane, so the arena has to grow.
+			auto fill = [](VectorBlock& vb, int layer, int index) {
+				for (int i = 0; i < 200 * (layer + 1); ++i) {
+					vb.mutable_line_sequence()->add_points(static_cast<float>(index + i));
+				}
+				vb.set_marking_params_key(index);
+				vb.mutable_meta_data()->set_contour_index(index);
+			};
+			auto read_file = [](const std::string& path) {
+				std::ifstream fs(path, std::ios::binary);
+				return std::string(std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>());
+			};
+
+			// ACT
+			{
+				JobWriter writer("test_arena_heap.ovf", job_shell);
+				for (int layer = 0; layer < 4; ++layer) {
+					WorkPlaneWriter wp_writer = writer.AppendWorkPlane(WorkPlane());
+					for (int index = 0; index < 50; ++index) {
+						VectorBlock vb;
+						fill(vb, layer, index);
+						wp_writer.AppendVectorBlock(vb);
+					}
+				}
+			}
+			{
+				JobWriter writer("test_arena.ovf", job_shell, small_arena);
+				for (int layer = 0; layer < 4; ++layer) {
+					WorkPlaneWriter wp_writer = writer.AppendWorkPlane(WorkPlane());
+					for (int index = 0; index < 50; ++index) {
+						VectorBlock* vb = wp_writer.CreateVectorBlock();
+						Assert::IsTrue(vb->GetArena() != nullptr, L"The block was not created on the arena.");
+						fill(*vb, layer, index);
+						wp_writer.AppendVectorBlock(*vb);
+					}
+				}
+			}
+
+			// ASSERT
+			Assert::IsTrue(read_file("test_arena.ovf") == read_file("test_arena_heap.ovf"),
+				L"Arena-backed blocks must not change the written bytes.");
+		}
+
+		TEST_METHOD(JobReader_OpenWorkPlane_ReadsBlocksByIndex)
+		{
+			// ARRANGE
+			const std::string filepath = "test_reader.ovf";
+			Job job_shell;
+			job_shell.mutable_job_meta_data()->set_job_name("ReaderJob");
+			{
+				JobWriter writer(filepath, job_shell);
+				for (int layer = 0; layer < 5; ++layer) {
+					WorkPlane wp_shell;
+					wp_shell.set_z_pos_in_mm(0.05 * layer);
+					WorkPlaneWriter wp_writer = writer.AppendWorkPlane(wp_shell);
+					for (int i = 0; i <= layer; ++i) {
+						VectorBlock vb = TestFixtures::CreateTriangleVectorBlock();
+						vb.set_marking_params_key(10 * layer + i);
+						wp_writer.AppendVectorBlock(vb);
+					}
+				}
+			}
+
+			// ACT
+			JobReader reader(filepath);
+			WorkPlaneReader wp_reader = reader.OpenWorkPlane(3);
+			WorkPlane read_shell;
+			wp_reader.ReadShell(read_shell);
+			VectorBlock read_vb;
+			wp_reader.ReadVectorBlock(2, read_vb);
+
+			// ASSERT
+			Assert::AreEqual(std::string("ReaderJob"), reader.JobShell().job_meta_data().job_name());
+			Assert::AreEqual(size_t(5), reader.WorkPlaneCount());
+			Assert::AreEqual(size_t(4), wp_reader.VectorBlockCount());
+			Assert::AreEqual(3, read_shell.work_plane_number());
+			Assert::AreEqual(4, read_shell.num_blocks());
+			Assert::AreEqual(32, read_vb.marking_params_key());
+			Assert::AreEqual(TestFixtures::CreateTriangleVectorBlock().line_sequence().SerializeAsString(),
+				read_vb.line_sequence().SerializeAsString());
+			Assert::ExpectException<std::out_of_range>([&] { reader.OpenWorkPlane(5); });
+			Assert::ExpectException<std::out_of_range>([&] { wp_reader.ReadVectorBlock(4, read_vb); });
+		}
+
+		TEST_METHOD(JobReader_ViewVectorBlock_MatchesParsedPoints)
+		{
+			// ARRANGE
+			// Blocks of differing sizes put the packed points at aligned and misaligned offsets.
+			const std::string filepath = "test_reader_view.ovf";
+			Job job_shell;
+			std::vector<VectorBlock> blocks;
+			for (int i = 0; i < 8; ++i) {
+				VectorBlock vb = TestFixtures::CreateTriangleVectorBlock();
+				for (int j = 0; j < i; ++j) {
+					vb.mutable_line_sequence()->add_points(0.5f * j);
+				}
+				vb.set_marking_params_key(i * 40);
+				blocks.push_back(vb);
+			}
+			VectorBlock hatches;
+			hatches.mutable__hatches()->add_points(1.0f);
+			hatches.mutable__hatches()->add_points(-2.5f);
+			blocks.push_back(hatches);
+			VectorBlock arcs;
+			arcs.mutable__arcs()->set_angle(90.0);
+			blocks.push_back(arcs);
+			{
+				JobWriter writer(filepath, job_shell);
+				WorkPlaneWriter wp_writer = writer.AppendWorkPlane(WorkPlane());
+				wp_writer.AppendVectorBlocks(blocks);
+			}
+
+			// ACT
+			JobReader reader(filepath);
+			WorkPlaneReader wp_reader = reader.OpenWorkPlane(0);
+			std::vector<float> scratch;
+
+			// ASSERT
+			Assert::AreEqual(blocks.size(), wp_reader.VectorBlockCount());
+			for (size_t i = 0; i < blocks.size(); ++i) {
+				VectorBlockView view = wp_reader.ViewVectorBlock(i);
+				VectorBlock parsed;
+				view.Parse(parsed);
+				Assert::AreEqual(blocks[i].SerializeAsString(), parsed.SerializeAsString());
+				Assert::AreEqual(static_cast<int>(blocks[i].vector_data_case()), static_cast<int>(view.DataCase()));
+				Assert::AreEqual(blocks[i].marking_params_key(), view.MarkingParamsKey());
+
+				const FloatSpan points = view.Points(scratch);
+				const google::protobuf::RepeatedField<float>& expected =
+					blocks[i].has__arcs() ? google::protobuf::RepeatedField<float>()
+					: blocks[i].has__hatches() ? blocks[i]._hatches().points() : blocks[i].line_sequence().points();
+				Assert::AreEqual(!blocks[i].has__arcs(), view.HasPoints());
+				Assert::AreEqual(static_cast<size_t>(expected.size()), points.size);
+				for (size_t j = 0; j < points.size; ++j) {
+					Assert::AreEqual(expected.Get(static_cast<int>(j)), points[j]);
+				}
+			}
+			Assert::ExpectException<std::out_of_range>([&] { wp_reader.ViewVectorBlock(blocks.size()); });
+		}
+
+		TEST_METHOD(JobReader_InvalidFile_Throws)
+		{
+			// ARRANGE
+			const std::string filepath = "test_reader_invalid.ovf";
+			{
+				std::ofstream fs(filepath, std::ios::binary);
+				fs << "not an ovf file";
+			}
+
+			// ACT & ASSERT
+			Assert::ExpectException<std::runtime_error>([&] { JobReader reader(filepath); });
+			Assert::ExpectException<std::runtime_error>([&] { JobReader reader("test_reader_missing.ovf"); });
+		}
+
+		TEST_METHOD(JobWriter_DeduplicateWorkPlanes_CollapsesIdenticalLayersIntoRepeats)
+		{
+			// ARRANGE
+			// Layers 0-4 are identical, layer 5 differs, layers 6-7 repeat it, and layer 8 has the
+			// same blocks again but breaks the z step.
+			const std::string filepath = "test_dedup.ovf";
+			Job job_shell;
+			(*job_shell.mutable_parts_map())[0].mutable_process_strategy()->set_layer_thickness_in_mm(0.03f);
+			JobWriterOptions options;
+			options.deduplicate_work_planes = true;
+			const float heights[] = { 0.0f, 0.03f, 0.06f, 0.09f, 0.12f, 0.15f, 0.18f, 0.21f, 0.5f };
+			VectorBlock triangle = TestFixtures::CreateTriangleVectorBlock();
+			VectorBlock other = TestFixtures::CreateTriangleVectorBlock();
+			other.set_marking_params_key(7);
+
+			// ACT
+			{
+				JobWriter writer(filepath, job_shell, options);
+				// Committed in reverse, so every segment but the first is parked first.
+				for (int layer = 8; layer >= 0; --layer) {
+					WorkPlane wp_shell;
+					wp_shell.set_z_pos_in_mm(heights[layer]);
+					WorkPlaneSegment segment(wp_shell);
+					segment.AppendVectorBlock(layer < 5 ? triangle : other);
+					writer.CommitWorkPlane(layer, std::move(segment));
+				}
+			}
+			JobReader reader(filepath);
+
+			// ASSERT
+			Assert::AreEqual(size_t(3), reader.WorkPlaneCount());
+			const uint32_t expected_repeats[] = { 4, 2, 0 };
+			const float expected_z[] = { 0.0f, 0.15f, 0.5f };
+			for (size_t i = 0; i < 3; ++i) {
+				WorkPlaneReader wp_reader = reader.OpenWorkPlane(i);
+				WorkPlane shell;
+				wp_reader.ReadShell(shell);
+				VectorBlock vb;
+				wp_reader.ReadVectorBlock(0, vb);
+				Assert::AreEqual(expected_repeats[i], shell.repeats());
+				Assert::AreEqual(expected_z[i], shell.z_pos_in_mm());
+				Assert::AreEqual(static_cast<int>(i), shell.work_plane_number());
+				Assert::AreEqual((i == 0 ? triangle : other).SerializeAsString(), vb.SerializeAsString());
+			}
+			Assert::AreEqual(3, reader.JobShell().num_work_planes());
+		}
+
+		TEST_METHOD(JobReader_DeduplicatedJob_ExpandsRepeatsToTheOriginalHeights)
+		{
+			// ARRANGE
+			// Runs of identical layers between differing ones, and a gap the size of two layers
+			// that must not be merged across.
+			const std::string filepath = "test_dedup_roundtrip.ovf";
+			const float thickness = 0.04f;
+			Job job_shell;
+			(*job_shell.mutable_parts_map())[0].mutable_process_strategy()->set_layer_thickness_in_mm(thickness);
+			(*job_shell.mutable_parts_map())[1].mutable_process_strategy()->set_layer_thickness_in_mm(thickness);
+			JobWriterOptions options;
+			options.deduplicate_work_planes = true;
+			std::vector<float> heights;
+			std::vector<int> contents;
+			for (int layer = 0; layer < 40; ++layer) {
+				if (layer == 25) {
+					continue;
+				}
+				heights.push_back(static_cast<float>(1.0 + layer * thickness));
+				contents.push_back(layer < 10 ? 0 : layer < 11 ? 1 : layer < 30 ? 2 : 0);
+			}
+
+			// ACT
+			{
+				JobWriter writer(filepath, job_shell, options);
+				for (size_t layer = 0; layer < heights.size(); ++layer) {
+					WorkPlane wp_shell;
+					wp_shell.set_z_pos_in_mm(heights[layer]);
+					WorkPlaneSegment segment(wp_shell);
+					VectorBlock vb = TestFixtures::CreateTriangleVectorBlock();
+					vb.set_marking_params_key(contents[layer]);
+					segment.AppendVectorBlock(vb);
+					writer.CommitWorkPlane(static_cast<int32_t>(layer), std::move(segment));
+				}
+			}
+			JobReader reader(filepath);
+			const float read_thickness = util::JobLayerThickness(reader.JobShell());
+			std::vector<float> expanded;
+			std::vector<int> expanded_contents;
+			for (size_t i = 0; i < reader.WorkPlaneCount(); ++i) {
+				WorkPlaneReader wp_reader = reader.OpenWorkPlane(i);
+				WorkPlane shell;
+				wp_reader.ReadShell(shell);
+				VectorBlock vb;
+				wp_reader.ReadVectorBlock(0, vb);
+				for (uint32_t k = 0; k <= shell.repeats(); ++k) {
+					expanded.push_back(static_cast<float>(shell.z_pos_in_mm() + k * static_cast<double>(read_thickness)));
+					expanded_contents.push_back(vb.marking_params_key());
+				}
+			}
+
+			// ASSERT
+			Assert::AreEqual(thickness, read_thickness);
+			Assert::AreEqual(size_t(5), reader.WorkPlaneCount());
+			Assert::AreEqual(heights.size(), expanded.size());
+			for (size_t layer = 0; layer < heights.size(); ++layer) {
+				Assert::AreEqual(heights[layer], expanded[layer], 1.0e-5f);
+				Assert::AreEqual(contents[layer], expanded_contents[layer]);
+			}
+		}
+
+		TEST_METHOD(JobWriter_DeduplicateWorkPlanes_NeedsALayerThickness)
+		{
+			// ARRANGE
+			const std::string filepath = "test_dedup_no_thickness.ovf";
+			Job job_shell;
+			JobWriterOptions options;
+			options.deduplicate_work_planes = true;
+
+			// ACT
+			{
+				JobWriter writer(filepath, job_shell, options);
+				for (int layer = 0; layer < 4; ++layer) {
+					WorkPlane wp_shell;
+					wp_shell.set_z_pos_in_mm(0.03f * layer);
+					WorkPlaneSegment segment(wp_shell);
+					segment.AppendVectorBlock(TestFixtures::CreateTriangleVectorBlock());
+					writer.CommitWorkPlane(layer, std::move(segment));
+				}
+			}
+			JobReader reader(filepath);
+
+			// ASSERT
+			Assert::AreEqual(size_t(4), reader.WorkPlaneCount());
+		}
+
+		TEST_METHOD(JobWriter_Close_ReportsFinalizationOnce)
+		{
+			// ARRANGE
+			Job job_shell;
+			JobWriterOptions options;
+			options.async_io = true;
+			JobWriter writer("test_async_close.ovf", job_shell, options);
+
+			// ACT
+			writer.Close();
+
+			// ASSERT
+			Assert::ExpectException<std::runtime_error>([&] { writer.Close(); });
+			Assert::ExpectException<std::runtime_error>([&] { writer.AppendWorkPlane(WorkPlane()); });
+			Assert::ExpectException<std::runtime_error>([&] { writer.CommitWorkPlane(0, WorkPlaneSegment()); });
+		}
 	};
 }
\ No newline at end of file
@@ -3,6 +3,11 @@
 
 // This is the public interface for our slicer library
 #include "StepSlicer.h"
+#include "ContourAssembler.h"
+#include "TestFixtures.h"
+
+#include <algorithm>
+#include <cmath>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 using namespace geometry;
@@ -38,5 +43,580 @@ namespace CadToOvfConverterTests
                 Assert::Fail(L"StepSlicer constructor threw an unexpected exception.");
             }
         }
+
+        TEST_METHOD(StepSlicer_ParallelSlice_MatchesSerialSlice)
+        {
+            // --- ARRANGE ---
+            const std::string filepath = "test_bracket_parallel.stp";
+            Assert::IsTrue(TestFixtures::WriteBracketStepFile(filepath), L"Failed to write the STEP fixture.");
+            StepSlicer slicer(filepath);
+
+            // --- ACT ---
+            auto serial_layers = slicer.Slice(0.5, 1);
+            auto parallel_layers = slicer.Slice(0.5, 4);
+            auto all_core_layers = slicer.Slice(0.5, 0);
+
+            // --- ASSERT ---
+            Assert::IsFalse(serial_layers.empty(), L"The serial slice produced no layers.");
+            Assert::IsTrue(TestFixtures::AreLayersIdentical(serial_layers, parallel_layers), L"4-thread slice differs from the serial slice.");
+            Assert::IsTrue(TestFixtures::AreLayersIdentical(serial_layers, all_core_layers), L"All-core slice differs from the serial slice.");
+        }
+
+        TEST_METHOD(StepSlicer_LoadMissingFile_ReturnsFalse)
+        {
+            StepSlicer slicer("does_not_exist.stp");
+
+            Assert::IsFalse(slicer.Load(), L"Loading a missing file should fail.");
+            Assert::IsFalse(slicer.IsLoaded(), L"A failed load must not leave a shape behind.");
+            Assert::IsTrue(slicer.Slice(0.5).empty(), L"Slicing without a model should produce no layers.");
+        }
+
+        TEST_METHOD(StepSlicer_LoadOnce_SlicesWithDifferentLayerHeights)
+        {
+            // --- ARRANGE ---
+            const std::string filepath = "test_bracket_reuse.stp";
+            Assert::IsTrue(TestFixtures::WriteBracketStepFile(filepath), L"Failed to write the STEP fixture.");
+            StepSlicer slicer(filepath);
+            Assert::IsTrue(slicer.Load(), L"Failed to load the STEP fixture.");
+
+            // --- ACT ---
+            auto coarse_layers = slicer.Slice(1.0);
+            auto fine_layers = slicer.Slice(0.5);
+
+            // --- ASSERT ---
+            Assert::IsTrue(slicer.IsLoaded());
+            Assert::IsFalse(slicer.BoundingBox().IsVoid(), L"The bounding box should be kept with the shape.");
+            Assert::IsFalse(coarse_layers.empty(), L"The coarse slice produced no layers.");
+            Assert::IsTrue(fine_layers.size() > coarse_layers.size(), L"A smaller layer height should produce more layers.");
+        }
+
+        TEST_METHOD(ShapeCache_SecondLoad_HitsCacheWithSameSlices)
+        {
+            // --- ARRANGE ---
+            const std::string filepath = "test_bracket_cache.stp";
+            Assert::IsTrue(TestFixtures::WriteBracketStepFile(filepath), L"Failed to write the STEP fixture.");
+            ShapeCache cache("test_shape_cache", 64ull << 20);
+            const std::string key = cache.MakeKey(filepath);
+            Assert::IsFalse(key.empty(), L"A readable STEP file must produce a cache key.");
+
+            // --- ACT ---
+            StepSlicer first_run(filepath);
+            Assert::IsTrue(first_run.Load(&cache), L"First load failed.");
+            TopoDS_Shape cached;
+            const bool hit = cache.Find(key, cached);
+            StepSlicer second_run(filepath);
+            Assert::IsTrue(second_run.Load(&cache), L"Cached load failed.");
+
+            // --- ASSERT ---
+            Assert::IsTrue(hit, L"The first load should have stored the shape.");
+            Assert::IsTrue(TestFixtures::AreLayersIdentical(first_run.Slice(1.0), second_run.Slice(1.0)),
+                L"Slices of the cached shape differ from slices of the STEP transfer.");
+        }
+
+        TEST_METHOD(ShapeCache_OverSizeCap_EvictsLeastRecentlyUsed)
+        {
+            // --- ARRANGE ---
+            const std::string filepath = "test_bracket_evict.stp";
+            Assert::IsTrue(TestFixtures::WriteBracketStepFile(filepath), L"Failed to write the STEP fixture.");
+            StepSlicer slicer(filepath);
+            Assert::IsTrue(slicer.Load(), L"Failed to load the STEP fixture.");
+
+            // A cache without room evicts every entry a previous run left in its directory.
+            const std::string probe_directory = "test_shape_cache_evict_probe";
+            const std::string directory = "test_shape_cache_evict";
+            {
+                ShapeCache stale_probe(probe_directory, 0);
+                ShapeCache stale(directory, 0);
+            }
+
+            // The size of one entry, measured in an empty cache.
+            ShapeCache probe(probe_directory, 64ull << 20);
+            Assert::AreEqual(size_t(0), probe.EntryCount(), L"The probe cache should start empty.");
+            Assert::IsTrue(probe.Store("probe", slicer.Shape()));
+            const uint64_t entry_size = probe.TotalSize();
+
+            // Room for two entries only.
+            ShapeCache cache(directory, entry_size * 2 + entry_size / 2);
+            Assert::AreEqual(size_t(0), cache.EntryCount(), L"The cache should start empty.");
+
+            // --- ACT ---
+            cache.Store("a", slicer.Shape());
+            cache.Store("b", slicer.Shape());
+            TopoDS_Shape shape;
+            cache.Find("a", shape); // "a" is now the most recently used entry.
+            cache.Store("c", slicer.Shape());
+
+            // --- ASSERT ---
+            Assert::IsTrue(cache.TotalSize() <= entry_size * 2 + entry_size / 2, L"The cache exceeds its size cap.");
+            Assert::IsTrue(cache.Find("a", shape), L"The recently used entry was evicted.");
+            Assert::IsTrue(cache.Find("c", shape), L"The newest entry was evicted.");
+            Assert::IsFalse(cache.Find("b", shape), L"The least recently used entry should have been evicted.");
+        }
+
+        TEST_METHOD(StepSlicer_MeshSweepEngine_ProducesClosedContours)
+        {
+            // --- ARRANGE ---
+            const std::string filepath = "test_bracket_mesh.stp";
+            Assert::IsTrue(TestFixtures::WriteBracketStepFile(filepath), L"Failed to write the STEP fixture.");
+            StepSlicer slicer(filepath);
+            Assert::IsTrue(slicer.Load(), L"Failed to load the STEP fixture.");
+
+            SliceOptions options;
+            options.layer_height = 0.5;
+            options.engine = SlicingEngine::MeshSweep;
+            options.mesh_deflection = 0.01;
+
+            // --- ACT ---
+            auto section_layers = slicer.Slice(0.5);
+            auto mesh_layers = slicer.Slice(options);
+
+            // --- ASSERT ---
+            // Empty layers are dropped by each engine on its own, so the layers are matched by height.
+            Assert::AreEqual(section_layers.size(), mesh_layers.size(), L"Both engines should slice the same layers.");
+            for (const auto& layer : mesh_layers) {
+                const bool sectioned = std::any_of(section_layers.begin(), section_layers.end(),
+                    [&layer](const geometry_contract::SlicedLayer& section) { return std::abs(section.ZHeight - layer.ZHeight) < 1e-9; });
+                Assert::IsTrue(sectioned, L"The section engine has no layer at this height.");
+                // The bracket cuts into a single loop on every layer: the box outline or the boss circle.
+                Assert::AreEqual(size_t(1), layer.contours.size(), L"Expected one welded loop per layer.");
+                const auto& points = layer.contours[0].points;
+                Assert::IsTrue(points.size() > 3, L"Loop has too few points.");
+                Assert::AreEqual(points.front().x, points.back().x, L"Loop is not closed in X.");
+                Assert::AreEqual(points.front().y, points.back().y, L"Loop is not closed in Y.");
+            }
+        }
+
+        TEST_METHOD(ContourAssembler_ShuffledSquareEdges_JoinIntoOneClosedLoop)
+        {
+            // --- ARRANGE ---
+            // The four sides of a square, out of order, two of them reversed, with tiny gaps.
+            std::vector<geometry_contract::Contour> pieces(4);
+            pieces[0].points = { { 10.0, 10.0 }, { 0.0, 10.0 } };
+            pieces[1].points = { { 0.0, 0.0 }, { 10.0, 0.0 } };
+            pieces[2].points = { { 0.0, 0.0 }, { 0.0, 10.0000001 } };
+            pieces[3].points = { { 10.0, 10.0 }, { 10.0000001, 0.0 } };
+            ContourAssembler assembler(1e-3);
+
+            // --- ACT ---
+            auto contours = assembler.Assemble(std::move(pieces));
+
+            // --- ASSERT ---
+            Assert::AreEqual(size_t(1), contours.size(), L"The square should assemble into one contour.");
+            Assert::IsTrue(contours[0].closed, L"The square should be closed.");
+            Assert::AreEqual(size_t(5), contours[0].points.size(), L"Four corners plus the closing point expected.");
+            Assert::AreEqual(size_t(0), assembler.LastOpenCount());
+        }
+
+        TEST_METHOD(ContourAssembler_GapLargerThanTolerance_ReportsOpenLoop)
+        {
+            std::vector<geometry_contract::Contour> pieces(2);
+            pieces[0].points = { { 0.0, 0.0 }, { 10.0, 0.0 }, { 10.0, 10.0 } };
+            pieces[1].points = { { 10.0, 10.0 }, { 0.0, 10.0 }, { 0.0, 0.5 } };
+            ContourAssembler assembler(1e-3);
+
+            auto contours = assembler.Assemble(std::move(pieces));
+
+            Assert::AreEqual(size_t(1), contours.size(), L"The two pieces should still be chained.");
+            Assert::IsFalse(contours[0].closed, L"A 0.5 mm gap must not be closed.");
+            Assert::AreEqual(size_t(1), assembler.LastOpenCount(), L"The open loop should be reported.");
+        }
+
+        TEST_METHOD(ContourAssembler_ZeroTolerance_JoinsOnlyCoincidentEnds)
+        {
+            // Two halves of a square meeting exactly, and a piece 1e-6 mm away from both.
+            std::vector<geometry_contract::Contour> pieces(3);
+            pieces[0].points = { { 0.0, 0.0 }, { 10.0, 0.0 }, { 10.0, 10.0 } };
+            pieces[1].points = { { 10.0, 10.0 }, { 0.0, 10.0 }, { 0.0, 0.0 } };
+            pieces[2].points = { { 20.0, 0.0 }, { 30.0, 0.0 }, { 30.0, 10.0 }, { 20.0, 0.000001 } };
+            ContourAssembler assembler(0.0);
+
+            auto contours = assembler.Assemble(std::move(pieces));
+
+            Assert::AreEqual(size_t(2), contours.size(), L"Only the coincident ends should be joined.");
+            Assert::IsTrue(contours[0].closed, L"The square should be closed.");
+            Assert::IsFalse(contours[1].closed, L"A gap must not be closed with a zero tolerance.");
+        }
+
+        TEST_METHOD(StepSlicer_SectionEngine_AssemblesClosedLoops)
+        {
+            const std::string filepath = "test_bracket_assembly.stp";
+            Assert::IsTrue(TestFixtures::WriteBracketStepFile(filepath), L"Failed to write the STEP fixture.");
+            StepSlicer slicer(filepath);
+
+            auto layers = slicer.Slice(0.5);
+
+            Assert::IsFalse(layers.empty(), L"The slice produced no layers.");
+            for (const auto& layer : layers) {
+                for (const auto& contour : layer.contours) {
+                    Assert::IsTrue(contour.closed, L"Every section of the solid bracket should close.");
+                }
+            }
+        }
+
+        TEST_METHOD(StepSlicer_AnalyticEmission_KeepsLinesAndCirclesExact)
+        {
+            // --- ARRANGE ---
+            const std::string filepath = "test_bracket_analytic.stp";
+            Assert::IsTrue(TestFixtures::WriteBracketStepFile(filepath), L"Failed to write the STEP fixture.");
+            StepSlicer slicer(filepath);
+            SliceOptions options;
+            options.layer_height = 0.5;
+            options.curve_emission = CurveEmission::Analytic;
+
+            // --- ACT ---
+            auto layers = slicer.Slice(options);
+
+            // --- ASSERT ---
+            Assert::IsFalse(layers.empty(), L"The slice produced no layers.");
+            for (const auto& layer : layers) {
+                if (layer.ZHeight < 5.0) {
+                    // The box outline: four two-point lines joined into one closed loop.
+                    Assert::AreEqual(size_t(1), layer.contours.size());
+                    Assert::AreEqual(size_t(5), layer.contours[0].points.size(), L"Lines should not be discretized.");
+                    Assert::IsTrue(layer.arcs.empty());
+                }
+                else {
+                    // The boss: a circle, emitted as arcs covering the full turn.
+                    Assert::IsTrue(layer.contours.empty(), L"Circles should not be discretized.");
+                    Assert::IsFalse(layer.arcs.empty(), L"The boss section should be emitted as arcs.");
+                    double total_angle = 0.0;
+                    for (const auto& arc : layer.arcs) {
+                        Assert::AreEqual(10.0, arc.center.x, 1e-6);
+                        Assert::AreEqual(5.0, arc.center.y, 1e-6);
+                        total_angle += std::abs(arc.angle);
+                    }
+                    Assert::AreEqual(360.0, total_angle, 1e-6, L"The arcs should cover the full circle.");
+                }
+            }
+        }
+
+        TEST_METHOD(StepSlicer_DiscretizationPolicy_ControlsPointCountAndSnapping)
+        {
+            // --- ARRANGE ---
+            const std::string filepath = "test_bracket_policy.stp";
+            Assert::IsTrue(TestFixtures::WriteBracketStepFile(filepath), L"Failed to write the STEP fixture.");
+            StepSlicer slicer(filepath);
+
+            SliceOptions coarse;
+            coarse.layer_height = 1.0;
+            coarse.discretization.chordal_deflection = 0.1;
+
+            SliceOptions fine = coarse;
+            fine.discretization.chordal_deflection = 0.001;
+            fine.discretization.angular_deflection = 0.05;
+            fine.discretization.snap_resolution = 0.01;
+
+            auto count_points = [](const std::vector<geometry_contract::SlicedLayer>& layers) {
+                size_t count = 0;
+                for (const auto& layer : layers)
+                    for (const auto& contour : layer.contours)
+                        count += contour.points.size();
+                return count;
+            };
+
+            // --- ACT ---
+            auto coarse_layers = slicer.Slice(coarse);
+            auto fine_layers = slicer.Slice(fine);
+
+            // --- ASSERT ---
+            Assert::IsTrue(count_points(fine_layers) > count_points(coarse_layers), L"A tighter policy should produce more points.");
+            for (const auto& layer : fine_layers) {
+                for (const auto& contour : layer.contours) {
+                    for (const auto& p : contour.points) {
+                        Assert::AreEqual(std::round(p.x / 0.01) * 0.01, p.x, 1e-12, L"X is not on the machine grid.");
+                        Assert::AreEqual(std::round(p.y / 0.01) * 0.01, p.y, 1e-12, L"Y is not on the machine grid.");
+                    }
+                }
+            }
+        }
+
+        TEST_METHOD(CurveEmitter_AppendPolyline_FiltersOnlyWhenThePolicyAsksForIt)
+        {
+            // --- ARRANGE ---
+            // A repeated point and a lone point, which only a filtering policy removes.
+            geometry_contract::Contour repeated;
+            repeated.points = { { 0.0, 0.0 }, { 1.0, 0.0 }, { 1.0, 0.0 }, { 1.0, 1.0 } };
+            geometry_contract::Contour lone;
+            lone.points = { { 2.0, 2.0 } };
+            DiscretizationPolicy snapping;
+            snapping.snap_resolution = 0.01;
+            const CurveEmitter plain(CurveEmission::Polyline, DiscretizationPolicy());
+            const CurveEmitter filtering(CurveEmission::Polyline, snapping);
+            geometry_contract::SlicedLayer plain_layer;
+            geometry_contract::SlicedLayer filtered_layer;
+
+            // --- ACT ---
+            plain.AppendPolyline(geometry_contract::Contour(repeated), plain_layer);
+            plain.AppendPolyline(geometry_contract::Contour(lone), plain_layer);
+            filtering.AppendPolyline(geometry_contract::Contour(repeated), filtered_layer);
+            filtering.AppendPolyline(geometry_contract::Contour(lone), filtered_layer);
+
+            // --- ASSERT ---
+            Assert::AreEqual(size_t(2), plain_layer.contours.size(), L"Without filtering every polyline is kept.");
+            Assert::AreEqual(size_t(4), plain_layer.contours[0].points.size(), L"Without filtering every point is kept.");
+            Assert::AreEqual(size_t(1), filtered_layer.contours.size(), L"The lone point should have been dropped.");
+            Assert::AreEqual(size_t(3), filtered_layer.contours[0].points.size(), L"The repeated point should have been dropped.");
+        }
+
+        TEST_METHOD(FaceZIndex_Query_ReturnsOnlyCrossingFaces)
+        {
+            // --- ARRANGE ---
+            const std::string filepath = "test_bracket_face_index.stp";
+            Assert::IsTrue(TestFixtures::WriteBracketStepFile(filepath), L"Failed to write the STEP fixture.");
+            StepSlicer slicer(filepath);
+            Assert::IsTrue(slicer.Load(), L"Failed to load the STEP fixture.");
+            FaceZIndex index(slicer.Shape());
+            std::vector<size_t> low_faces, high_faces, outside_faces;
+
+            // --- ACT ---
+            index.Query(2.5, low_faces);
+            index.Query(7.0, high_faces);
+            index.Query(50.0, outside_faces);
+
+            // --- ASSERT ---
+            // Four box walls below the boss; the cylinder wall (possibly split in two) above it.
+            Assert::AreEqual(size_t(4), low_faces.size(), L"Only the box walls cross z = 2.5.");
+            Assert::IsTrue(!high_faces.empty() && high_faces.size() <= 2, L"Only the boss wall crosses z = 7.");
+            Assert::IsTrue(outside_faces.empty(), L"No face crosses a plane above the part.");
+        }
+
+        TEST_METHOD(StepSlicer_FaceIndex_MatchesFullModelSection)
+        {
+            const std::string filepath = "test_bracket_face_index_slice.stp";
+            Assert::IsTrue(TestFixtures::WriteBracketStepFile(filepath), L"Failed to write the STEP fixture.");
+            StepSlicer slicer(filepath);
+            SliceOptions indexed;
+            indexed.layer_height = 0.5;
+            SliceOptions full = indexed;
+            full.use_face_index = false;
+
+            auto indexed_layers = slicer.Slice(indexed);
+            auto full_layers = slicer.Slice(full);
+
+            Assert::AreEqual(full_layers.size(), indexed_layers.size(), L"Both paths should produce the same layers.");
+            for (size_t i = 0; i < full_layers.size(); ++i) {
+                Assert::AreEqual(full_layers[i].ZHeight, indexed_layers[i].ZHeight);
+                Assert::AreEqual(full_layers[i].contours.size(), indexed_layers[i].contours.size(), L"Contour count differs.");
+            }
+        }
+
+        TEST_METHOD(StepSlicer_AnalyticFaces_MatchBooleanSection)
+        {
+            // --- ARRANGE ---
+            const std::string filepath = "test_bracket_analytic_faces.stp";
+            Assert::IsTrue(TestFixtures::WriteBracketStepFile(filepath), L"Failed to write the STEP fixture.");
+            StepSlicer slicer(filepath);
+            SliceOptions analytic;
+            analytic.layer_height = 0.5;
+            analytic.curve_emission = CurveEmission::Analytic;
+            SliceOptions boolean = analytic;
+            boolean.analytic_faces = false;
+
+            // --- ACT ---
+            auto analytic_layers = slicer.Slice(analytic);
+            auto boolean_layers = slicer.Slice(boolean);
+
+            // --- ASSERT ---
+            Assert::AreEqual(boolean_layers.size(), analytic_layers.size(), L"Both paths should produce the same layers.");
+            for (size_t i = 0; i < boolean_layers.size(); ++i) {
+                const auto& expected = boolean_layers[i];
+                const auto& actual = analytic_layers[i];
+                Assert::AreEqual(expected.ZHeight, actual.ZHeight);
+                Assert::AreEqual(expected.contours.size(), actual.contours.size(), L"Contour count differs.");
+                for (size_t c = 0; c < actual.contours.size(); ++c) {
+                    Assert::AreEqual(expected.contours[c].closed, actual.contours[c].closed, L"Closed state differs.");
+                }
+                double expected_angle = 0.0, actual_angle = 0.0;
+                for (const auto& arc : expected.arcs) expected_angle += std::abs(arc.angle);
+                for (const auto& arc : actual.arcs) actual_angle += std::abs(arc.angle);
+                Assert::AreEqual(expected_angle, actual_angle, 1e-6, L"The arcs should cover the same sweep.");
+            }
+        }
+
+        TEST_METHOD(PrismaticRegions_Bracket_SplitsAtTheBossBase)
+        {
+            // --- ARRANGE ---
+            const std::string filepath = "test_bracket_prismatic.stp";
+            Assert::IsTrue(TestFixtures::WriteBracketStepFile(filepath), L"Failed to write the STEP fixture.");
+            StepSlicer slicer(filepath);
+            Assert::IsTrue(slicer.Load(), L"Failed to load the STEP fixture.");
+            PrismaticRegions regions(slicer.Shape());
+            size_t low = 0, low_again = 0, high = 0, at_base = 0;
+
+            // --- ACT ---
+            const bool low_found = regions.RegionAt(0.5, low);
+            const bool low_again_found = regions.RegionAt(4.5, low_again);
+            const bool high_found = regions.RegionAt(7.0, high);
+            const bool base_found = regions.RegionAt(5.0, at_base);
+
+            // --- ASSERT ---
+            // Only vertical walls between the bottom, the box top and the boss top.
+            Assert::IsTrue(low_found && low_again_found && high_found, L"The box and the boss are prismatic.");
+            Assert::AreEqual(low, low_again, L"The box walls form one region.");
+            Assert::AreNotEqual(low, high, L"The boss base separates two regions.");
+            Assert::IsFalse(base_found, L"The box top is a critical height.");
+        }
+
+        TEST_METHOD(StepSlicer_PrismaticReuse_MatchesSectioningEveryLayer)
+        {
+            // --- ARRANGE ---
+            const std::string filepath = "test_bracket_prismatic_slice.stp";
+            Assert::IsTrue(TestFixtures::WriteBracketStepFile(filepath), L"Failed to write the STEP fixture.");
+            StepSlicer slicer(filepath);
+            SliceOptions reuse;
+            reuse.layer_height = 0.25;
+            reuse.thread_count = 4;
+            reuse.layer_window = 5;
+            SliceOptions every_layer = reuse;
+            every_layer.reuse_prismatic_sections = false;
+
+            // --- ACT ---
+            auto reused_layers = slicer.Slice(reuse);
+            auto full_layers = slicer.Slice(every_layer);
+            std::vector<geometry_contract::SlicedLayer> single_layers;
+            for (const auto& layer : full_layers) {
+                single_layers.push_back(slicer.SliceLayer(layer.ZHeight, reuse));
+            }
+
+            // --- ASSERT ---
+            Assert::AreEqual(full_layers.size(), reused_layers.size(), L"Both paths should produce the same layers.");
+            for (size_t i = 0; i < full_layers.size(); ++i) {
+                for (const auto* actual : { &reused_layers[i], &single_layers[i] }) {
+                    Assert::AreEqual(full_layers[i].ZHeight, actual->ZHeight);
+                    Assert::AreEqual(full_layers[i].contours.size(), actual->contours.size(), L"Contour count differs.");
+                    for (size_t c = 0; c < actual->contours.size(); ++c) {
+                        const auto& expected_points = full_layers[i].contours[c].points;
+                        const auto& actual_points = actual->contours[c].points;
+                        Assert::AreEqual(expected_points.size(), actual_points.size(), L"Point count differs.");
+                        for (size_t p = 0; p < actual_points.size(); ++p) {
+                            Assert::AreEqual(expected_points[p].x, actual_points[p].x, 1e-9);
+                            Assert::AreEqual(expected_points[p].y, actual_points[p].y, 1e-9);
+                        }
+                    }
+                }
+            }
+        }
+
+        TEST_METHOD(MarchingSlicer_Bracket_CarriesSectionsBetweenCriticalHeights)
+        {
+            // --- ARRANGE ---
+            // Without analytic faces every wall is tracked; only the box top and the boss top
+            // change the topology.
+            const std::string filepath = "test_bracket_marching.stp";
+            Assert::IsTrue(TestFixtures::WriteBracketStepFile(filepath), L"Failed to write the STEP fixture.");
+            StepSlicer slicer(filepath);
+            Assert::IsTrue(slicer.Load(), L"Failed to load the STEP fixture.");
+            FaceZIndex index(slicer.Shape());
+            MarchingSlicer marcher(index, CurveEmission::Polyline, DiscretizationPolicy(), false);
+            size_t layers_with_contours = 0;
+
+            // --- ACT ---
+            for (double z = 0.25; z < 9.0; z += 0.25) {
+                if (!marcher.SliceAt(z).contours.empty()) {
+                    ++layers_with_contours;
+                }
+            }
+
+            // --- ASSERT ---
+            Assert::AreEqual(size_t(35), layers_with_contours, L"Every layer inside the part has contours.");
+            Assert::IsTrue(marcher.MarchedSectionCount() > 0, L"Sections should be carried between layers.");
+            Assert::IsTrue(marcher.FullSectionCount() < marcher.MarchedSectionCount(), L"Most sections should be marched.");
+        }
+
+        TEST_METHOD(MarchingSlicer_AnalyticEmission_KeepsTrackedFacesAsPolylines)
+        {
+            // --- ARRANGE ---
+            // The boss wall is a cylinder; tracked, it must not turn into an arc on the layers
+            // where it is sectioned and into a polyline on those it is marched to.
+            const std::string filepath = "test_bracket_marching_analytic.stp";
+            Assert::IsTrue(TestFixtures::WriteBracketStepFile(filepath), L"Failed to write the STEP fixture.");
+            StepSlicer slicer(filepath);
+            Assert::IsTrue(slicer.Load(), L"Failed to load the STEP fixture.");
+            FaceZIndex index(slicer.Shape());
+            MarchingSlicer marcher(index, CurveEmission::Analytic, DiscretizationPolicy(), false);
+
+            for (double z = 0.25; z < 9.0; z += 0.25) {
+                // --- ACT ---
+                const auto layer = marcher.SliceAt(z);
+
+                // --- ASSERT ---
+                Assert::IsTrue(layer.arcs.empty() && layer.ellipses.empty(), L"Tracked faces should emit polylines.");
+                Assert::IsFalse(layer.contours.empty(), L"Every layer inside the part has contours.");
+            }
+            Assert::IsTrue(marcher.MarchedSectionCount() > 0, L"Sections should be carried between layers.");
+        }
+
+        TEST_METHOD(StepSlicer_MarchingEngine_MatchesSectionEngine)
+        {
+            // --- ARRANGE ---
+            const std::string filepath = "test_bracket_marching_slice.stp";
+            Assert::IsTrue(TestFixtures::WriteBracketStepFile(filepath), L"Failed to write the STEP fixture.");
+            StepSlicer slicer(filepath);
+            SliceOptions section;
+            section.layer_height = 0.25;
+            section.analytic_faces = false;
+            section.reuse_prismatic_sections = false;
+            SliceOptions marching = section;
+            marching.engine = SlicingEngine::Marching;
+
+            // --- ACT ---
+            auto section_layers = slicer.Slice(section);
+            auto marching_layers = slicer.Slice(marching);
+
+            // --- ASSERT ---
+            Assert::AreEqual(section_layers.size(), marching_layers.size(), L"Both engines should produce the same layers.");
+            for (size_t i = 0; i < section_layers.size(); ++i) {
+                const auto& expected = section_layers[i];
+                const auto& actual = marching_layers[i];
+                Assert::AreEqual(expected.ZHeight, actual.ZHeight);
+                Assert::AreEqual(expected.contours.size(), actual.contours.size(), L"Contour count differs.");
+                for (size_t c = 0; c < actual.contours.size(); ++c) {
+                    Assert::AreEqual(expected.contours[c].closed, actual.contours[c].closed, L"Closed state differs.");
+                }
+                // The polylines may be sampled differently, but they trace the same walls.
+                if (std::abs(actual.ZHeight - 5.0) < 1e-6) {
+                    continue; // The box top holds both.
+                }
+                for (const auto& contour : actual.contours) {
+                    for (const auto& p : contour.points) {
+                        const bool on_box = p.x > -1e-6 && p.x < 20.0 + 1e-6 && p.y > -1e-6 && p.y < 10.0 + 1e-6;
+                        const bool on_boss = std::abs(std::hypot(p.x - 10.0, p.y - 5.0) - 3.0) < 1e-6;
+                        Assert::IsTrue(actual.ZHeight < 5.0 ? on_box : on_boss, L"A marched point left the wall.");
+                    }
+                }
+            }
+        }
+
+        TEST_METHOD(StepSlicer_LayerSink_StreamsLayersInZOrder)
+        {
+            // --- ARRANGE ---
+            const std::string filepath = "test_bracket_sink.stp";
+            Assert::IsTrue(TestFixtures::WriteBracketStepFile(filepath), L"Failed to write the STEP fixture.");
+            StepSlicer slicer(filepath);
+            SliceOptions options;
+            options.layer_height = 0.5;
+            options.thread_count = 4;
+            options.layer_window = 3; // Smaller than the layer count, so several windows are needed.
+
+            auto expected = slicer.Slice(0.5);
+            std::vector<geometry_contract::SlicedLayer> streamed;
+            size_t stop_after = 5;
+            size_t received_before_stop = 0;
+
+            // --- ACT ---
+            bool completed = slicer.Slice(options, [&](geometry_contract::SlicedLayer&& layer) {
+                streamed.push_back(std::move(layer));
+                return true;
+            });
+            bool stopped = !slicer.Slice(options, [&](geometry_contract::SlicedLayer&&) {
+                return ++received_before_stop < stop_after;
+            });
+
+            // --- ASSERT ---
+            Assert::IsTrue(completed, L"The slice should run to the end.");
+            Assert::IsTrue(TestFixtures::AreLayersIdentical(expected, streamed), L"Streamed layers differ from the collected ones.");
+            Assert::IsTrue(stopped, L"The sink should be able to stop the slice.");
+            Assert::AreEqual(stop_after, received_before_stop, L"No layer should arrive after the sink stopped.");
+        }
     };
 }
\ No newline at end of file
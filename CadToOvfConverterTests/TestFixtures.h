@@ -5,6 +5,13 @@
 #include <vector>
 #include "google/protobuf/io/zero_copy_stream_impl.h"
 #include "google/protobuf/util/delimited_message_util.h"
+#include "GeometryContract.h"
+
+#include <BRepPrimAPI_MakeBox.hxx>
+#include <BRepPrimAPI_MakeCylinder.hxx>
+#include <BRepAlgoAPI_Fuse.hxx>
+#include <STEPControl_Writer.hxx>
+#include <gp_Ax2.hxx>
 
 namespace TestFixtures {
 
@@ -54,4 +61,45 @@ namespace TestFixtures {
         google::protobuf::io::ArrayInputStream ais(buffer.data(), static_cast<int>(buffer.size()));
         return google::protobuf::util::ParseDelimitedFromZeroCopyStream(&message, &ais, nullptr);
     }
+
+    // Writes a small bracket-like part (a box with a cylinder on top) as a STEP file,
+    // so slicer tests have planar, cylindrical and multi-edge sections to work with.
+    inline bool WriteBracketStepFile(const std::string& filepath)
+    {
+        TopoDS_Shape base = BRepPrimAPI_MakeBox(20.0, 10.0, 5.0).Shape();
+        TopoDS_Shape boss = BRepPrimAPI_MakeCylinder(gp_Ax2(gp_Pnt(10.0, 5.0, 5.0), gp_Dir(0, 0, 1)), 3.0, 4.0).Shape();
+        BRepAlgoAPI_Fuse fuse(base, boss);
+        if (!fuse.IsDone()) return false;
+
+        STEPControl_Writer writer;
+        if (writer.Transfer(fuse.Shape(), STEPControl_AsIs) != IFSelect_RetDone) return false;
+        return writer.Write(filepath.c_str()) == IFSelect_RetDone;
+    }
+
+    inline bool AreLayersIdentical(const std::vector<geometry_contract::SlicedLayer>& a,
+                                   const std::vector<geometry_contract::SlicedLayer>& b)
+    {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (a[i].ZHeight != b[i].ZHeight) return false;
+            if (a[i].contours.size() != b[i].contours.size()) return false;
+            for (size_t c = 0; c < a[i].contours.size(); ++c) {
+                const auto& pa = a[i].contours[c].points;
+                const auto& pb = b[i].contours[c].points;
+                if (pa.size() != pb.size()) return false;
+                for (size_t p = 0; p < pa.size(); ++p) {
+                    if (pa[p].x != pb[p].x || pa[p].y != pb[p].y) return false;
+                }
+            }
+            if (a[i].arcs.size() != b[i].arcs.size() || a[i].ellipses.size() != b[i].ellipses.size()) return false;
+            for (size_t c = 0; c < a[i].arcs.size(); ++c) {
+                const auto& arc_a = a[i].arcs[c];
+                const auto& arc_b = b[i].arcs[c];
+                if (arc_a.center.x != arc_b.center.x || arc_a.center.y != arc_b.center.y ||
+                    arc_a.start.x != arc_b.start.x || arc_a.start.y != arc_b.start.y ||
+                    arc_a.angle != arc_b.angle) return false;
+            }
+        }
+        return true;
+    }
 }
\ No newline at end of file
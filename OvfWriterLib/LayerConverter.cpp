@@ -0,0 +1,300 @@
+// OvfWriterLib/LayerConverter.cpp
+
+#include "LayerConverter.h"
+#include "OvfWriter.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX__)
+#define OVF_PACK_AVX
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OVF_PACK_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace open_vector_format {
+    namespace writer {
+
+        namespace {
+
+            const double kPi = 3.14159265358979323846;
+            const double kDegToRad = kPi / 180.0;
+
+            // The vector paths read the points as a plain array of x, y doubles.
+            static_assert(sizeof(geometry_contract::Point2D) == 2 * sizeof(double), "Point2D must be two packed doubles.");
+
+            struct Extent {
+                double min_x, min_y, max_x, max_y;
+
+                void Add(double x, double y) {
+                    min_x = std::min(min_x, x);
+                    min_y = std::min(min_y, y);
+                    max_x = std::max(max_x, x);
+                    max_y = std::max(max_y, y);
+                }
+            };
+
+            void SetBounds(const Extent& extent, VectorBlock& block) {
+                auto* bounds = block.mutable_meta_data()->mutable_bounds();
+                bounds->set_x_min(static_cast<float>(extent.min_x));
+                bounds->set_y_min(static_cast<float>(extent.min_y));
+                bounds->set_x_max(static_cast<float>(extent.max_x));
+                bounds->set_y_max(static_cast<float>(extent.max_y));
+            }
+
+            /**
+             * @brief Narrows count >= 1 points into out and measures them.
+             * @param out Receives 2 * count floats.
+             * @param extent Receives the bounds of the points.
+             * @return The length of the polyline through the points.
+             */
+            double PackPoints(const geometry_contract::Point2D* points, size_t count, float* out, Extent& extent) {
+
+                const double* src = &points[0].x;
+                extent = { src[0], src[1], src[0], src[1] };
+                out[0] = static_cast<float>(src[0]);
+                out[1] = static_cast<float>(src[1]);
+                double length = 0.0;
+                size_t i = 1;
+
+#if defined(OVF_PACK_AVX)
+                // Four points per step, as two (x, y, x, y) registers. The previous points are
+                // the same registers loaded one point earlier.
+                __m256d lo = _mm256_set_pd(src[1], src[0], src[1], src[0]);
+                __m256d hi = lo;
+                __m256d lengths = _mm256_setzero_pd();
+                for (; i + 4 <= count; i += 4) {
+                    const double* p = src + 2 * i;
+                    const __m256d a = _mm256_loadu_pd(p);
+                    const __m256d b = _mm256_loadu_pd(p + 4);
+                    _mm_storeu_ps(out + 2 * i, _mm256_cvtpd_ps(a));
+                    _mm_storeu_ps(out + 2 * i + 4, _mm256_cvtpd_ps(b));
+                    lo = _mm256_min_pd(lo, _mm256_min_pd(a, b));
+                    hi = _mm256_max_pd(hi, _mm256_max_pd(a, b));
+                    const __m256d da = _mm256_sub_pd(a, _mm256_loadu_pd(p - 2));
+                    const __m256d db = _mm256_sub_pd(b, _mm256_loadu_pd(p + 2));
+                    // hadd pairs dx^2 + dy^2 within each 128-bit lane, one segment per lane.
+                    const __m256d squared = _mm256_hadd_pd(_mm256_mul_pd(da, da), _mm256_mul_pd(db, db));
+                    lengths = _mm256_add_pd(lengths, _mm256_sqrt_pd(squared));
+                }
+                double lo_lanes[4], hi_lanes[4], length_lanes[4];
+                _mm256_storeu_pd(lo_lanes, lo);
+                _mm256_storeu_pd(hi_lanes, hi);
+                _mm256_storeu_pd(length_lanes, lengths);
+                extent.Add(lo_lanes[0], lo_lanes[1]);
+                extent.Add(lo_lanes[2], lo_lanes[3]);
+                extent.Add(hi_lanes[0], hi_lanes[1]);
+                extent.Add(hi_lanes[2], hi_lanes[3]);
+                length = length_lanes[0] + length_lanes[1] + length_lanes[2] + length_lanes[3];
+#elif defined(OVF_PACK_SSE2)
+                // Two points per step, one (x, y) register each.
+                __m128d lo = _mm_loadu_pd(src);
+                __m128d hi = lo;
+                __m128d lengths = _mm_setzero_pd();
+                for (; i + 2 <= count; i += 2) {
+                    const double* p = src + 2 * i;
+                    const __m128d a = _mm_loadu_pd(p);
+                    const __m128d b = _mm_loadu_pd(p + 2);
+                    _mm_storeu_ps(out + 2 * i, _mm_movelh_ps(_mm_cvtpd_ps(a), _mm_cvtpd_ps(b)));
+                    lo = _mm_min_pd(lo, _mm_min_pd(a, b));
+                    hi = _mm_max_pd(hi, _mm_max_pd(a, b));
+                    const __m128d da = _mm_sub_pd(a, _mm_loadu_pd(p - 2));
+                    const __m128d db = _mm_sub_pd(b, a);
+                    const __m128d sa = _mm_mul_pd(da, da);
+                    const __m128d sb = _mm_mul_pd(db, db);
+                    const __m128d squared = _mm_add_pd(_mm_unpacklo_pd(sa, sb), _mm_unpackhi_pd(sa, sb));
+                    lengths = _mm_add_pd(lengths, _mm_sqrt_pd(squared));
+                }
+                double lo_lanes[2], hi_lanes[2], length_lanes[2];
+                _mm_storeu_pd(lo_lanes, lo);
+                _mm_storeu_pd(hi_lanes, hi);
+                _mm_storeu_pd(length_lanes, lengths);
+                extent.Add(lo_lanes[0], lo_lanes[1]);
+                extent.Add(hi_lanes[0], hi_lanes[1]);
+                length = length_lanes[0] + length_lanes[1];
+#endif
+
+                for (; i < count; ++i) {
+                    const double x = src[2 * i];
+                    const double y = src[2 * i + 1];
+                    out[2 * i] = static_cast<float>(x);
+                    out[2 * i + 1] = static_cast<float>(y);
+                    extent.Add(x, y);
+                    length += std::hypot(x - src[2 * i - 2], y - src[2 * i - 1]);
+                }
+                return length;
+            }
+
+            // Point of an ellipse at parametric angle t.
+            void EllipsePoint(const geometry_contract::Point2D& center, double a, double b, double rotation, double t,
+                              double& x, double& y) {
+                const double cos_r = std::cos(rotation), sin_r = std::sin(rotation);
+                const double u = a * std::cos(t), v = b * std::sin(t);
+                x = center.x + u * cos_r - v * sin_r;
+                y = center.y + u * sin_r + v * cos_r;
+            }
+
+            /**
+             * @brief Bounds of the ellipse part swept from t0 by sweep (radians, positive counter-clockwise).
+             *
+             * Besides the end points, the arc can only reach its extent where dx/dt or dy/dt vanishes,
+             * which happens at two parameters per axis.
+             */
+            Extent EllipticArcExtent(const geometry_contract::Point2D& center, double a, double b, double rotation,
+                                     double t0, double sweep) {
+                double x, y;
+                EllipsePoint(center, a, b, rotation, t0, x, y);
+                Extent extent = { x, y, x, y };
+                EllipsePoint(center, a, b, rotation, t0 + sweep, x, y);
+                extent.Add(x, y);
+
+                const double tx = std::atan2(-b * std::sin(rotation), a * std::cos(rotation));
+                const double ty = std::atan2(b * std::cos(rotation), a * std::sin(rotation));
+                const double critical[4] = { tx, tx + kPi, ty, ty + kPi };
+                for (double t : critical) {
+                    // Distance from t0 to t in the sweep direction, in [0, 2 pi).
+                    double offset = std::fmod(sweep >= 0.0 ? t - t0 : t0 - t, 2.0 * kPi);
+                    if (offset < 0.0) {
+                        offset += 2.0 * kPi;
+                    }
+                    if (offset <= std::abs(sweep)) {
+                        EllipsePoint(center, a, b, rotation, t, x, y);
+                        extent.Add(x, y);
+                    }
+                }
+                return extent;
+            }
+
+            // Length of the ellipse part swept from t0 by sweep, by Simpson's rule.
+            double EllipticArcLength(double a, double b, double t0, double sweep) {
+                const int intervals = 64;
+                const double h = sweep / intervals;
+                auto speed = [a, b](double t) { return std::hypot(a * std::sin(t), b * std::cos(t)); };
+                double sum = speed(t0) + speed(t0 + sweep);
+                for (int i = 1; i < intervals; ++i) {
+                    sum += (i % 2 ? 4.0 : 2.0) * speed(t0 + i * h);
+                }
+                return std::abs(sum * h / 3.0);
+            }
+        }
+
+        void ContourToVectorBlock(const geometry_contract::Contour& contour, VectorBlock& block) {
+            auto* points = block.mutable_line_sequence()->mutable_points();
+            const size_t count = contour.points.size();
+            points->Resize(static_cast<int>(2 * count), 0.0f);
+            if (count == 0) {
+                block.mutable_meta_data()->clear_bounds();
+                block.mutable_meta_data()->set_total_scan_distance_in_mm(0.0);
+                return;
+            }
+
+            Extent extent;
+            const double length = PackPoints(contour.points.data(), count, points->mutable_data(), extent);
+            SetBounds(extent, block);
+            block.mutable_meta_data()->set_total_scan_distance_in_mm(length);
+        }
+
+        void ArcToVectorBlock(const geometry_contract::Arc& arc, VectorBlock& block) {
+            const double dx = arc.start.x - arc.center.x;
+            const double dy = arc.start.y - arc.center.y;
+            const double radius = std::hypot(dx, dy);
+            const double sweep = arc.angle * kDegToRad;
+
+            auto* arcs = block.mutable__arcs();
+            arcs->set_angle(arc.angle);
+            arcs->set_start_dx(static_cast<float>(dx));
+            arcs->set_start_dy(static_cast<float>(dy));
+            arcs->mutable_centers()->Clear();
+            arcs->add_centers(static_cast<float>(arc.center.x));
+            arcs->add_centers(static_cast<float>(arc.center.y));
+
+            SetBounds(EllipticArcExtent(arc.center, radius, radius, 0.0, std::atan2(dy, dx), sweep), block);
+            block.mutable_meta_data()->set_total_scan_distance_in_mm(radius * std::abs(sweep));
+        }
+
+        void EllipticArcToVectorBlock(const geometry_contract::EllipticArc& arc, VectorBlock& block) {
+            const double rotation = arc.rotation * kDegToRad;
+            const double sweep = arc.angle * kDegToRad;
+            const double dx = arc.start.x - arc.center.x;
+            const double dy = arc.start.y - arc.center.y;
+            // The start point in the ellipse's own frame gives its parametric angle.
+            const double u = dx * std::cos(rotation) + dy * std::sin(rotation);
+            const double v = -dx * std::sin(rotation) + dy * std::cos(rotation);
+            const double t0 = std::atan2(v / arc.minor_radius, u / arc.major_radius);
+
+            auto* ellipses = block.mutable_ellipses();
+            ellipses->set_a(static_cast<float>(arc.major_radius));
+            ellipses->set_b(static_cast<float>(arc.minor_radius));
+            ellipses->set_phi0(arc.rotation);
+            auto* arcs = ellipses->mutable_ellipses_arcs();
+            arcs->set_angle(arc.angle);
+            arcs->set_start_dx(static_cast<float>(dx));
+            arcs->set_start_dy(static_cast<float>(dy));
+            arcs->mutable_centers()->Clear();
+            arcs->add_centers(static_cast<float>(arc.center.x));
+            arcs->add_centers(static_cast<float>(arc.center.y));
+
+            SetBounds(EllipticArcExtent(arc.center, arc.major_radius, arc.minor_radius, rotation, t0, sweep), block);
+            block.mutable_meta_data()->set_total_scan_distance_in_mm(
+                EllipticArcLength(arc.major_radius, arc.minor_radius, t0, sweep));
+        }
+
+        void ContourToRawBlock(const geometry_contract::Contour& contour, std::vector<float>& points, RawBlockFields& fields) {
+            const size_t count = contour.points.size();
+            points.resize(2 * count);
+            fields.has_meta_data = true;
+            fields.total_scan_distance_in_mm = 0.0;
+            fields.has_bounds = false;
+            if (count == 0) {
+                return;
+            }
+
+            Extent extent;
+            fields.total_scan_distance_in_mm = PackPoints(contour.points.data(), count, points.data(), extent);
+            fields.has_bounds = true;
+            fields.x_min = static_cast<float>(extent.min_x);
+            fields.y_min = static_cast<float>(extent.min_y);
+            fields.x_max = static_cast<float>(extent.max_x);
+            fields.y_max = static_cast<float>(extent.max_y);
+        }
+
+        namespace {
+            // Shared by both AppendLayer overloads; Writer is a WorkPlaneWriter or a WorkPlaneSegment.
+            template <class Writer>
+            void AppendLayerTo(const geometry_contract::SlicedLayer& layer, int32_t marking_params_key, Writer& writer) {
+                // The points buffer and the block are refilled for every piece, so their
+                // buffers are only allocated once per layer.
+                std::vector<float> points;
+                RawBlockFields fields;
+                fields.marking_params_key = marking_params_key;
+                for (const auto& contour : layer.contours) {
+                    ContourToRawBlock(contour, points, fields);
+                    writer.BeginLineSequenceBlock(fields);
+                    writer.AppendPoints(points.data(), points.size());
+                    writer.EndLineSequenceBlock();
+                }
+
+                VectorBlock block;
+                block.set_marking_params_key(marking_params_key);
+                for (const auto& arc : layer.arcs) {
+                    ArcToVectorBlock(arc, block);
+                    writer.AppendVectorBlock(block);
+                }
+                for (const auto& ellipse : layer.ellipses) {
+                    EllipticArcToVectorBlock(ellipse, block);
+                    writer.AppendVectorBlock(block);
+                }
+            }
+        }
+
+        void AppendLayer(const geometry_contract::SlicedLayer& layer, int32_t marking_params_key, WorkPlaneWriter& writer) {
+            AppendLayerTo(layer, marking_params_key, writer);
+        }
+
+        void AppendLayer(const geometry_contract::SlicedLayer& layer, int32_t marking_params_key, WorkPlaneSegment& segment) {
+            AppendLayerTo(layer, marking_params_key, segment);
+        }
+    }
+} // namespace open_vector_format::writer
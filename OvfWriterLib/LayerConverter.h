@@ -0,0 +1,70 @@
+// OvfWriterLib/LayerConverter.h
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "open_vector_format.pb.h"
+#include "GeometryContract.h"
+#include "LineSequenceEncoder.h"
+
+namespace open_vector_format {
+    namespace writer {
+
+        class WorkPlaneWriter;
+        class WorkPlaneSegment;
+
+        /**
+         * @brief Converts a contour into a LineSequence VectorBlock.
+         *
+         * The double x, y pairs are narrowed into the packed float points field in a
+         * single pass (AVX or SSE2 when the build targets it, scalar otherwise), which
+         * also fills meta_data.bounds and meta_data.total_scan_distance_in_mm.
+         * Fields other than the geometry and those two meta data entries are left untouched.
+         * @param contour The source polyline.
+         * @param block The VectorBlock to fill. Reusing one block reuses its buffers.
+         */
+        void ContourToVectorBlock(const geometry_contract::Contour& contour, VectorBlock& block);
+
+        /**
+         * @brief Converts a contour into packed points for raw LineSequence emission.
+         *
+         * Same narrowing pass as ContourToVectorBlock. The bounds and the scan distance go
+         * into fields, so that emitting points with fields gives the bytes of the block
+         * ContourToVectorBlock would build.
+         * @param points Receives the packed points. Reusing one vector reuses its buffer.
+         * @param fields Receives the meta data. Its other members are left untouched.
+         */
+        void ContourToRawBlock(const geometry_contract::Contour& contour, std::vector<float>& points, RawBlockFields& fields);
+
+        /**
+         * @brief Converts a circular arc into an Arcs VectorBlock with a single center.
+         *
+         * Bounds and scan distance are exact for the swept part of the circle.
+         */
+        void ArcToVectorBlock(const geometry_contract::Arc& arc, VectorBlock& block);
+
+        /**
+         * @brief Converts an elliptic arc into an Ellipses VectorBlock.
+         *
+         * Bounds are exact for the swept part of the ellipse. The scan distance is
+         * integrated numerically, as elliptic arc lengths have no closed form.
+         */
+        void EllipticArcToVectorBlock(const geometry_contract::EllipticArc& arc, VectorBlock& block);
+
+        /**
+         * @brief Appends every contour, arc and elliptic arc of a layer as its own VectorBlock.
+         *
+         * Contours are emitted as raw LineSequence blocks, without building a VectorBlock.
+         * @param layer The sliced layer.
+         * @param marking_params_key Key into the job's marking_params_map used for every block.
+         * @param writer The WorkPlaneWriter of the layer's work plane.
+         */
+        void AppendLayer(const geometry_contract::SlicedLayer& layer, int32_t marking_params_key, WorkPlaneWriter& writer);
+
+        /**
+         * @brief Like AppendLayer above, but into a WorkPlaneSegment that is committed later.
+         */
+        void AppendLayer(const geometry_contract::SlicedLayer& layer, int32_t marking_params_key, WorkPlaneSegment& segment);
+    }
+} // namespace open_vector_format::writer
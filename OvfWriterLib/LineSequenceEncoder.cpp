@@ -0,0 +1,170 @@
+// OvfWriterLib/LineSequenceEncoder.cpp
+
+#include "LineSequenceEncoder.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/wire_format_lite.h"
+
+namespace open_vector_format {
+    namespace writer {
+
+        namespace {
+            using google::protobuf::io::CodedOutputStream;
+            using google::protobuf::internal::WireFormatLite;
+
+            // Field numbers of open_vector_format.proto.
+            enum VectorBlockField {
+                kLineSequence = 1,
+                kMarkingParamsKey = 50,
+                kLaserIndex = 53,
+                kRepeats = 54,
+                kMetaData = 100,
+            };
+            enum LineSequenceField { kPoints = 1 };
+            enum MetaDataField {
+                kTotalScanDistance = 1,
+                kTotalJumpDistance = 2,
+                kPartKey = 3,
+                kPatchKey = 4,
+                kContourIndex = 5,
+                kBounds = 6,
+                kDisplayColor = 7,
+            };
+            enum BoundsField { kXMin = 1, kYMin = 2, kXMax = 3, kYMax = 4 };
+
+            uint32_t Tag(int field, WireFormatLite::WireType type) {
+                return WireFormatLite::MakeTag(field, type);
+            }
+
+            // Proto3 writes a scalar only when it differs from zero; for floating point
+            // values that means any bit pattern but +0.0, so -0.0 is written.
+            bool IsSet(float value) {
+                uint32_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                return bits != 0;
+            }
+
+            bool IsSet(double value) {
+                uint64_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                return bits != 0;
+            }
+
+            size_t Int32FieldSize(int field, int32_t value) {
+                return value == 0 ? 0 : CodedOutputStream::VarintSize32(Tag(field, WireFormatLite::WIRETYPE_VARINT))
+                                        + CodedOutputStream::VarintSize32SignExtended(value);
+            }
+
+            size_t LengthDelimitedSize(int field, size_t length) {
+                return CodedOutputStream::VarintSize32(Tag(field, WireFormatLite::WIRETYPE_LENGTH_DELIMITED))
+                       + CodedOutputStream::VarintSize32(static_cast<uint32_t>(length)) + length;
+            }
+
+            uint8_t* WriteInt32(int field, int32_t value, uint8_t* target) {
+                return value == 0 ? target : WireFormatLite::WriteInt32ToArray(field, value, target);
+            }
+
+            uint8_t* WriteFloat(int field, float value, uint8_t* target) {
+                return IsSet(value) ? WireFormatLite::WriteFloatToArray(field, value, target) : target;
+            }
+
+            uint8_t* WriteDouble(int field, double value, uint8_t* target) {
+                return IsSet(value) ? WireFormatLite::WriteDoubleToArray(field, value, target) : target;
+            }
+
+            uint8_t* WriteLengthDelimitedHeader(int field, size_t length, uint8_t* target) {
+                target = WireFormatLite::WriteTagToArray(field, WireFormatLite::WIRETYPE_LENGTH_DELIMITED, target);
+                return CodedOutputStream::WriteVarint32ToArray(static_cast<uint32_t>(length), target);
+            }
+        }
+
+        void LineSequenceEncoder::Begin(const RawBlockFields& fields) {
+            m_fields = fields;
+            m_spans.clear();
+            m_float_count = 0;
+        }
+
+        void LineSequenceEncoder::AppendPoints(const float* xy, size_t float_count) {
+            if (float_count > 0) {
+                m_spans.emplace_back(xy, float_count);
+                m_float_count += float_count;
+            }
+        }
+
+        size_t LineSequenceEncoder::LineSequenceSize() const {
+            // A packed field is left out entirely when it is empty.
+            return m_float_count == 0 ? 0 : LengthDelimitedSize(kPoints, m_float_count * sizeof(float));
+        }
+
+        size_t LineSequenceEncoder::BoundsSize() const {
+            const size_t field_size = 1 + sizeof(float); // One-byte tag and a fixed32 value.
+            return (IsSet(m_fields.x_min) ? field_size : 0) + (IsSet(m_fields.y_min) ? field_size : 0)
+                   + (IsSet(m_fields.x_max) ? field_size : 0) + (IsSet(m_fields.y_max) ? field_size : 0);
+        }
+
+        size_t LineSequenceEncoder::MetaDataSize() const {
+            const size_t double_size = 1 + sizeof(double);
+            size_t size = (IsSet(m_fields.total_scan_distance_in_mm) ? double_size : 0)
+                          + (IsSet(m_fields.total_jump_distance_in_mm) ? double_size : 0)
+                          + Int32FieldSize(kPartKey, m_fields.part_key)
+                          + Int32FieldSize(kPatchKey, m_fields.patch_key)
+                          + Int32FieldSize(kContourIndex, m_fields.contour_index)
+                          + Int32FieldSize(kDisplayColor, m_fields.display_color);
+            if (m_fields.has_bounds) {
+                size += LengthDelimitedSize(kBounds, BoundsSize());
+            }
+            return size;
+        }
+
+        size_t LineSequenceEncoder::BlockSize() const {
+            // The oneof member is written even when the LineSequence itself is empty.
+            size_t size = LengthDelimitedSize(kLineSequence, LineSequenceSize())
+                          + Int32FieldSize(kMarkingParamsKey, m_fields.marking_params_key)
+                          + Int32FieldSize(kLaserIndex, m_fields.laser_index);
+            if (m_fields.repeats != 0) {
+                size += CodedOutputStream::VarintSize32(Tag(kRepeats, WireFormatLite::WIRETYPE_VARINT))
+                        + CodedOutputStream::VarintSize64(m_fields.repeats);
+            }
+            if (m_fields.has_meta_data) {
+                size += LengthDelimitedSize(kMetaData, MetaDataSize());
+            }
+            return size;
+        }
+
+        uint8_t* LineSequenceEncoder::WriteHead(size_t block_size, uint8_t* target) const {
+            target = CodedOutputStream::WriteVarint32ToArray(static_cast<uint32_t>(block_size), target);
+            target = WriteLengthDelimitedHeader(kLineSequence, LineSequenceSize(), target);
+            if (m_float_count > 0) {
+                target = WriteLengthDelimitedHeader(kPoints, m_float_count * sizeof(float), target);
+            }
+            return target;
+        }
+
+        uint8_t* LineSequenceEncoder::WriteTail(uint8_t* target) const {
+            // Fields follow in field number order, as the generated code writes them.
+            target = WriteInt32(kMarkingParamsKey, m_fields.marking_params_key, target);
+            target = WriteInt32(kLaserIndex, m_fields.laser_index, target);
+            if (m_fields.repeats != 0) {
+                target = WireFormatLite::WriteUInt64ToArray(kRepeats, m_fields.repeats, target);
+            }
+            if (!m_fields.has_meta_data) {
+                return target;
+            }
+
+            target = WriteLengthDelimitedHeader(kMetaData, MetaDataSize(), target);
+            target = WriteDouble(kTotalScanDistance, m_fields.total_scan_distance_in_mm, target);
+            target = WriteDouble(kTotalJumpDistance, m_fields.total_jump_distance_in_mm, target);
+            target = WriteInt32(kPartKey, m_fields.part_key, target);
+            target = WriteInt32(kPatchKey, m_fields.patch_key, target);
+            target = WriteInt32(kContourIndex, m_fields.contour_index, target);
+            if (m_fields.has_bounds) {
+                target = WriteLengthDelimitedHeader(kBounds, BoundsSize(), target);
+                target = WriteFloat(kXMin, m_fields.x_min, target);
+                target = WriteFloat(kYMin, m_fields.y_min, target);
+                target = WriteFloat(kXMax, m_fields.x_max, target);
+                target = WriteFloat(kYMax, m_fields.y_max, target);
+            }
+            target = WriteInt32(kDisplayColor, m_fields.display_color, target);
+            return target;
+        }
+    }
+} // namespace open_vector_format::writer
@@ -0,0 +1,122 @@
+// OvfWriterLib/LineSequenceEncoder.h
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include "OvfUtil.h"
+
+namespace open_vector_format {
+    namespace writer {
+
+        /**
+         * @brief The VectorBlock fields written around a raw LineSequence.
+         *
+         * Mirrors the fields of VectorBlock and VectorBlockMetaData that carry no vector
+         * data. As in the generated code, a field equal to zero is not written.
+         */
+        struct RawBlockFields {
+            int32_t marking_params_key = 0;
+            int32_t laser_index = 0;
+            uint64_t repeats = 0;
+
+            // meta_data is only written when set, like a VectorBlock with has_meta_data().
+            bool has_meta_data = false;
+            double total_scan_distance_in_mm = 0.0;
+            double total_jump_distance_in_mm = 0.0;
+            int32_t part_key = 0;
+            int32_t patch_key = 0;
+            int32_t contour_index = 0;
+            // meta_data.bounds is only written when set, like a VectorBlockMetaData with has_bounds().
+            bool has_bounds = false;
+            float x_min = 0.0f;
+            float y_min = 0.0f;
+            float x_max = 0.0f;
+            float y_max = 0.0f;
+            int32_t display_color = 0;
+        };
+
+        /**
+         * @brief Encodes a LineSequence VectorBlock straight from caller-owned points.
+         *
+         * Produces the length-delimited record that serializing the equivalent VectorBlock
+         * would, byte for byte, without building the message: the points are copied once,
+         * from the caller's arrays into the output. Points are referenced, not copied, until
+         * WriteTo(), so the arrays must outlive it. The encoder keeps its span list between
+         * blocks, so after the first few blocks it does not allocate.
+         */
+        class LineSequenceEncoder {
+        public:
+            // Starts a block, dropping any points of the previous one.
+            void Begin(const RawBlockFields& fields);
+
+            // Appends float_count floats, interleaved x and y, to the block's points.
+            void AppendPoints(const float* xy, size_t float_count);
+
+            size_t FloatCount() const { return m_float_count; }
+
+            // Size of the serialized VectorBlock, without the length prefix.
+            size_t BlockSize() const;
+
+            /**
+             * @brief Writes the length-delimited record.
+             * @param write Called as write(const void* data, size_t size) for consecutive pieces of the record.
+             */
+            template <class Sink>
+            void WriteTo(Sink&& write) const;
+
+        private:
+            size_t LineSequenceSize() const;
+            size_t MetaDataSize() const;
+            size_t BoundsSize() const;
+            // Encodes everything before the points into target and returns its end.
+            uint8_t* WriteHead(size_t block_size, uint8_t* target) const;
+            // Encodes everything after the points into target and returns its end.
+            uint8_t* WriteTail(uint8_t* target) const;
+
+            // Large enough for the record length, the VectorBlock and LineSequence headers.
+            static const size_t kMaxHeadSize = 32;
+            // Large enough for every scalar field and the meta data.
+            static const size_t kMaxTailSize = 128;
+
+            RawBlockFields m_fields;
+            std::vector<std::pair<const float*, size_t>> m_spans;
+            size_t m_float_count = 0;
+        };
+
+        template <class Sink>
+        void LineSequenceEncoder::WriteTo(Sink&& write) const {
+            uint8_t head[kMaxHeadSize];
+            write(head, static_cast<size_t>(WriteHead(BlockSize(), head) - head));
+
+            if (!util::IsSystemBigEndian()) {
+                for (const auto& span : m_spans) {
+                    write(span.first, span.second * sizeof(float));
+                }
+            }
+            else {
+                // The wire format stores floats little-endian.
+                uint8_t chunk[256 * sizeof(float)];
+                for (const auto& span : m_spans) {
+                    for (size_t first = 0; first < span.second; first += 256) {
+                        const size_t count = span.second - first < 256 ? span.second - first : 256;
+                        for (size_t i = 0; i < count; ++i) {
+                            uint32_t bits;
+                            std::memcpy(&bits, span.first + first + i, sizeof(bits));
+                            for (size_t b = 0; b < sizeof(bits); ++b) {
+                                chunk[i * sizeof(bits) + b] = static_cast<uint8_t>(bits >> (8 * b));
+                            }
+                        }
+                        write(chunk, count * sizeof(float));
+                    }
+                }
+            }
+
+            uint8_t tail[kMaxTailSize];
+            write(tail, static_cast<size_t>(WriteTail(tail) - tail));
+        }
+    }
+} // namespace open_vector_format::writer
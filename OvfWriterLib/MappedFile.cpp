@@ -0,0 +1,110 @@
+// OvfWriterLib/MappedFile.cpp
+
+#include "MappedFile.h"
+
+#include <stdexcept>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace open_vector_format {
+    namespace reader {
+
+#if defined(_WIN32)
+
+        MappedFile::MappedFile(const std::string& path) {
+            // Readers jump between LUTs and blocks, so tell the cache manager not to read ahead.
+            HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                      FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+            if (file == INVALID_HANDLE_VALUE) {
+                throw std::runtime_error("Failed to open file for reading: " + path);
+            }
+            m_file = file;
+
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(file, &size)) {
+                CloseHandle(file);
+                throw std::runtime_error("Failed to query the size of: " + path);
+            }
+            m_size = static_cast<uint64_t>(size.QuadPart);
+            if (m_size == 0) {
+                return; // Empty files cannot be mapped, and there is nothing to map.
+            }
+
+            m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (m_mapping != nullptr) {
+                m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+            }
+            if (m_data == nullptr) {
+                if (m_mapping != nullptr) {
+                    CloseHandle(m_mapping);
+                }
+                CloseHandle(file);
+                throw std::runtime_error("Failed to map file: " + path);
+            }
+        }
+
+        MappedFile::~MappedFile() {
+            if (m_data != nullptr) {
+                UnmapViewOfFile(m_data);
+            }
+            if (m_mapping != nullptr) {
+                CloseHandle(m_mapping);
+            }
+            if (m_file != nullptr) {
+                CloseHandle(m_file);
+            }
+        }
+
+#else
+
+        MappedFile::MappedFile(const std::string& path) {
+            m_fd = open(path.c_str(), O_RDONLY);
+            if (m_fd < 0) {
+                throw std::runtime_error("Failed to open file for reading: " + path);
+            }
+
+            struct stat status;
+            if (fstat(m_fd, &status) != 0) {
+                close(m_fd);
+                throw std::runtime_error("Failed to query the size of: " + path);
+            }
+            m_size = static_cast<uint64_t>(status.st_size);
+            if (m_size == 0) {
+                return; // Empty files cannot be mapped, and there is nothing to map.
+            }
+
+            void* data = mmap(nullptr, static_cast<size_t>(m_size), PROT_READ, MAP_PRIVATE, m_fd, 0);
+            if (data == MAP_FAILED) {
+                close(m_fd);
+                throw std::runtime_error("Failed to map file: " + path);
+            }
+            // Readers jump between LUTs and blocks, so read-ahead would mostly load unused pages.
+            madvise(data, static_cast<size_t>(m_size), MADV_RANDOM);
+            m_data = static_cast<const uint8_t*>(data);
+        }
+
+        MappedFile::~MappedFile() {
+            if (m_data != nullptr) {
+                munmap(const_cast<uint8_t*>(m_data), static_cast<size_t>(m_size));
+            }
+            if (m_fd >= 0) {
+                close(m_fd);
+            }
+        }
+
+#endif
+    }
+} // namespace open_vector_format::reader
@@ -0,0 +1,46 @@
+// OvfWriterLib/MappedFile.h
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace open_vector_format {
+    namespace reader {
+
+        /**
+         * @brief A whole file mapped read-only into memory.
+         *
+         * The operating system pages the file in on access, so opening even a huge file
+         * costs no reads, and only the touched pages are ever loaded. Concurrent reads of
+         * the mapping are safe.
+         */
+        class MappedFile {
+        public:
+            /**
+             * @brief Maps the file.
+             * @throws std::runtime_error if the file cannot be opened or mapped.
+             */
+            explicit MappedFile(const std::string& path);
+            ~MappedFile();
+
+            const uint8_t* Data() const { return m_data; }
+            uint64_t Size() const { return m_size; }
+
+            // The mapping is tied to this object, so it can neither be copied nor moved.
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+        private:
+            const uint8_t* m_data = nullptr;
+            uint64_t m_size = 0;
+#if defined(_WIN32)
+            void* m_file = nullptr;    // HANDLE of the file.
+            void* m_mapping = nullptr; // HANDLE of the file mapping object.
+#else
+            int m_fd = -1;
+#endif
+        };
+    }
+} // namespace open_vector_format::reader
@@ -0,0 +1,229 @@
+// OvfWriterLib/OvfOutputStream.cpp
+
+#include "OvfOutputStream.h"
+#include "OvfUtil.h"
+#include "google/protobuf/io/coded_stream.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+namespace open_vector_format {
+    namespace writer {
+
+        OvfOutputStream::OvfOutputStream(const std::string& path, size_t buffer_size, bool async, size_t buffer_count)
+            : m_buffer_size(std::min<size_t>(std::max<size_t>(buffer_size, 4096), INT_MAX)),
+            m_async(async),
+            m_spare_buffers(std::max<size_t>(buffer_count, 2) - 1)
+        {
+            // The stream already writes whole buffers, a second buffer in the filebuf would only copy them again.
+            m_file.rdbuf()->pubsetbuf(nullptr, 0);
+            m_file.open(path, std::ios::binary);
+            m_good = m_file.is_open() && m_file.good();
+            m_current.data.reset(new char[m_buffer_size]);
+
+            m_async = m_async && m_good;
+            if (m_async) {
+                m_io_thread = std::thread(&OvfOutputStream::IoThreadLoop, this);
+            }
+        }
+
+        OvfOutputStream::~OvfOutputStream() {
+            if (m_file.is_open()) {
+                Close();
+            }
+            if (m_io_thread.joinable()) {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stop = true;
+                }
+                m_changed.notify_all();
+                m_io_thread.join();
+            }
+        }
+
+        bool OvfOutputStream::Next(void** data, int* size) {
+            if (m_used == m_buffer_size && !SubmitCurrent()) {
+                return false;
+            }
+            *data = m_current.data.get() + m_used;
+            *size = static_cast<int>(m_buffer_size - m_used);
+            m_used = m_buffer_size;
+            return true;
+        }
+
+        void OvfOutputStream::BackUp(int count) {
+            m_used -= static_cast<size_t>(count);
+        }
+
+        bool OvfOutputStream::SubmitCurrent() {
+            if (m_used == 0) {
+                return m_good;
+            }
+            m_current.size = m_used;
+            m_submitted_bytes += m_used;
+            m_used = 0;
+
+            if (!m_async) {
+                m_file.write(m_current.data.get(), static_cast<std::streamsize>(m_current.size));
+                m_good = m_good && m_file.good();
+                return m_good;
+            }
+
+            // Hand the buffer over, then continue in a free one. Back-pressure: with every
+            // buffer queued for the disk, wait for the I/O thread to return one.
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_full.push_back(std::move(m_current));
+            m_changed.notify_all();
+            if (m_free.empty() && m_spare_buffers > 0) {
+                --m_spare_buffers;
+                m_current.data.reset(new char[m_buffer_size]);
+            }
+            else {
+                m_changed.wait(lock, [this] { return !m_free.empty(); });
+                m_current = std::move(m_free.back());
+                m_free.pop_back();
+            }
+            m_current.size = 0;
+            return m_good;
+        }
+
+        void OvfOutputStream::IoThreadLoop() {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            for (;;) {
+                m_changed.wait(lock, [this] { return m_stop || !m_full.empty(); });
+                if (m_full.empty()) {
+                    return; // Stopping, and everything has been written.
+                }
+                Buffer buffer = std::move(m_full.front());
+                m_full.pop_front();
+                m_io_busy = true;
+                const bool skip = m_io_failed; // After a failure the rest is discarded, but buffers still cycle.
+                lock.unlock();
+
+                bool ok = true;
+                if (!skip) {
+                    m_file.write(buffer.data.get(), static_cast<std::streamsize>(buffer.size));
+                    ok = m_file.good();
+                }
+
+                lock.lock();
+                m_io_busy = false;
+                m_io_failed = m_io_failed || !ok;
+                m_free.push_back(std::move(buffer));
+                m_changed.notify_all();
+            }
+        }
+
+        void OvfOutputStream::WriteRaw(const void* data, size_t size) {
+            const uint8_t* source = static_cast<const uint8_t*>(data);
+            while (size > 0) {
+                void* target;
+                int available;
+                if (!Next(&target, &available)) {
+                    m_good = false;
+                    return;
+                }
+                const size_t chunk = std::min(size, static_cast<size_t>(available));
+                std::memcpy(target, source, chunk);
+                BackUp(available - static_cast<int>(chunk));
+                source += chunk;
+                size -= chunk;
+            }
+        }
+
+        void OvfOutputStream::WriteLittleEndian(uint64_t value) {
+            uint8_t bytes[sizeof(uint64_t)];
+            util::EncodeLittleEndian(value, bytes);
+            WriteRaw(bytes, sizeof(bytes));
+        }
+
+        void OvfOutputStream::WriteDelimited(const google::protobuf::MessageLite& message) {
+            // Measuring caches the size, unless it does not fit the cache.
+            if (message.ByteSizeLong() > static_cast<size_t>(INT_MAX)) {
+                m_good = false;
+                return;
+            }
+            WriteDelimitedWithCachedSize(message);
+        }
+
+        void OvfOutputStream::WriteDelimitedWithCachedSize(const google::protobuf::MessageLite& message) {
+            using google::protobuf::io::CodedOutputStream;
+
+            const size_t message_size = static_cast<size_t>(message.GetCachedSize());
+            const uint32_t size = static_cast<uint32_t>(message_size);
+            const size_t total = CodedOutputStream::VarintSize32(size) + message_size;
+
+            if (m_buffer_size - m_used >= total) {
+                // The common case: the whole record fits into the current buffer.
+                uint8_t* target = reinterpret_cast<uint8_t*>(m_current.data.get() + m_used);
+                target = CodedOutputStream::WriteVarint32ToArray(size, target);
+                message.SerializeWithCachedSizesToArray(target);
+                m_used += total;
+                return;
+            }
+
+            // The record straddles a buffer boundary; let a coded stream split it.
+            CodedOutputStream coded(static_cast<google::protobuf::io::ZeroCopyOutputStream*>(this));
+            coded.WriteVarint32(size);
+            message.SerializeWithCachedSizes(&coded);
+            if (coded.HadError()) {
+                m_good = false;
+            }
+        }
+
+        uint8_t* OvfOutputStream::Claim(size_t size) {
+            if (size > m_buffer_size || (m_buffer_size - m_used < size && !SubmitCurrent())) {
+                return nullptr;
+            }
+            uint8_t* target = reinterpret_cast<uint8_t*>(m_current.data.get() + m_used);
+            m_used += size;
+            return target;
+        }
+
+        bool OvfOutputStream::Flush() {
+            SubmitCurrent();
+            if (m_async) {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_changed.wait(lock, [this] { return m_full.empty() && !m_io_busy; });
+                m_good = m_good && !m_io_failed;
+            }
+            return m_good;
+        }
+
+        void OvfOutputStream::PatchLittleEndian(uint64_t position, uint64_t value) {
+            // Flush() leaves the I/O thread idle, so the file can be used directly.
+            if (!Flush()) {
+                return;
+            }
+            WritePatch(position, value);
+            m_file.seekp(0, std::ios::end);
+            m_good = m_good && m_file.good();
+        }
+
+        void OvfOutputStream::QueuePatchLittleEndian(uint64_t position, uint64_t value) {
+            m_queued_patches.emplace_back(position, value);
+        }
+
+        void OvfOutputStream::WritePatch(uint64_t position, uint64_t value) {
+            uint8_t bytes[sizeof(uint64_t)];
+            util::EncodeLittleEndian(value, bytes);
+            m_file.seekp(static_cast<std::streamoff>(position));
+            m_file.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+        }
+
+        bool OvfOutputStream::Close() {
+            Flush();
+            // Ascending order turns the patch pass into one forward sweep over the file.
+            std::sort(m_queued_patches.begin(), m_queued_patches.end());
+            for (const auto& patch : m_queued_patches) {
+                WritePatch(patch.first, patch.second);
+            }
+            m_queued_patches.clear();
+            m_good = m_good && m_file.good();
+            m_file.close();
+            m_good = m_good && !m_file.fail();
+            return m_good;
+        }
+    }
+} // namespace open_vector_format::writer
@@ -0,0 +1,142 @@
+// OvfWriterLib/OvfOutputStream.h
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "google/protobuf/io/zero_copy_stream.h"
+#include "google/protobuf/message_lite.h"
+
+namespace open_vector_format {
+    namespace writer {
+
+        /**
+         * @brief Sequential binary output file behind large, rotating write buffers.
+         *
+         * Messages are serialized straight into the current buffer. A full buffer goes to
+         * the file in a single write, either right away or, in asynchronous mode, on a
+         * dedicated I/O thread while the caller fills the next buffer. The caller blocks
+         * only when every buffer is waiting for the disk. The stream counts the bytes it
+         * has accepted, so Position() never has to query (and thereby flush) the file.
+         *
+         * Errors are sticky. In synchronous mode Good() turns false on the failing call.
+         * In asynchronous mode a failed disk write is only reported by Flush() and Close(),
+         * so the call that sees the error does not depend on thread timing.
+         */
+        class OvfOutputStream : private google::protobuf::io::ZeroCopyOutputStream {
+        public:
+            /**
+             * @param path The file to create or truncate.
+             * @param buffer_size Size of each write buffer in bytes.
+             * @param async Write full buffers on a background thread.
+             * @param buffer_count Buffers used in asynchronous mode, at least 2.
+             */
+            OvfOutputStream(const std::string& path, size_t buffer_size, bool async = false, size_t buffer_count = 2);
+            ~OvfOutputStream() override;
+
+            bool IsOpen() const { return m_file.is_open(); }
+            bool Good() const { return m_good; }
+
+            /**
+             * @brief The number of bytes written so far, which is the file offset of the next write.
+             */
+            uint64_t Position() const { return m_submitted_bytes + m_used; }
+
+            void WriteRaw(const void* data, size_t size);
+
+            // Writes a 64-bit integer in little-endian byte order.
+            void WriteLittleEndian(uint64_t value);
+
+            // Writes the message's size as a varint followed by the message itself.
+            void WriteDelimited(const google::protobuf::MessageLite& message);
+
+            // Like WriteDelimited(), for a message whose size ByteSizeLong() has cached and
+            // found to be at most INT_MAX.
+            void WriteDelimitedWithCachedSize(const google::protobuf::MessageLite& message);
+
+            /**
+             * @brief Reserves size bytes at the current position, for the caller to fill in place.
+             *
+             * The bytes lie in one buffer, so a new one is started if the current one has less
+             * room left. They must be filled before the next call to the stream.
+             * @return The reserved bytes, or nullptr if size exceeds a buffer or the write failed.
+             */
+            uint8_t* Claim(size_t size);
+
+            // The bytes Claim() can reserve without starting a new buffer, and with.
+            size_t Room() const { return m_buffer_size - m_used; }
+            size_t BufferSize() const { return m_buffer_size; }
+
+            /**
+             * @brief Overwrites 8 already written bytes with a little-endian integer.
+             *
+             * Flushes the buffers and seeks, so it costs a random write. The following
+             * writes continue at the end of the file.
+             */
+            void PatchLittleEndian(uint64_t position, uint64_t value);
+
+            /**
+             * @brief Like PatchLittleEndian(), but only records the patch.
+             *
+             * Queued patches are applied in one ascending pass by Close(), so the file is
+             * written strictly sequentially until then.
+             */
+            void QueuePatchLittleEndian(uint64_t position, uint64_t value);
+
+            // Hands every written byte to the file and waits until it is there. Returns Good().
+            bool Flush();
+
+            // Writes out the buffers, applies the queued patches and closes the file. Returns Good().
+            bool Close();
+
+            OvfOutputStream(const OvfOutputStream&) = delete;
+            OvfOutputStream& operator=(const OvfOutputStream&) = delete;
+
+        private:
+            struct Buffer {
+                std::unique_ptr<char[]> data;
+                size_t size = 0; // Bytes in use.
+            };
+
+            // ZeroCopyOutputStream, used by WriteDelimited for records that straddle buffers.
+            bool Next(void** data, int* size) override;
+            void BackUp(int count) override;
+            int64_t ByteCount() const override { return static_cast<int64_t>(Position()); }
+
+            // Passes the current buffer on to the file and makes a free one current.
+            bool SubmitCurrent();
+            void IoThreadLoop();
+            // Seeks to position and writes value there, leaving the file position behind it.
+            void WritePatch(uint64_t position, uint64_t value);
+
+            std::ofstream m_file;
+            const size_t m_buffer_size;
+            Buffer m_current;
+            size_t m_used = 0;             // Bytes used in m_current.
+            uint64_t m_submitted_bytes = 0; // Bytes in buffers already passed on.
+            std::vector<std::pair<uint64_t, uint64_t>> m_queued_patches; // (position, value)
+            bool m_good = true;
+
+            // --- Asynchronous mode ---
+            bool m_async; // Cleared if the file could not be opened, so no thread is waited for.
+            std::thread m_io_thread;
+            std::mutex m_mutex;
+            std::condition_variable m_changed;
+            std::deque<Buffer> m_full;    // Waiting for the I/O thread, oldest first.
+            std::vector<Buffer> m_free;   // Written out and ready for reuse.
+            size_t m_spare_buffers;       // Buffers that may still be allocated.
+            bool m_io_busy = false;       // The I/O thread is writing a buffer.
+            bool m_io_failed = false;
+            bool m_stop = false;
+        };
+    }
+} // namespace open_vector_format::writer
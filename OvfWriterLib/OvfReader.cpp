@@ -0,0 +1,267 @@
+// OvfWriterLib/OvfReader.cpp
+
+#include "OvfReader.h"
+#include "OvfUtil.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/wire_format_lite.h"
+
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+
+namespace open_vector_format {
+    namespace reader {
+
+        namespace {
+            const uint8_t kMagic[] = { 0x4f, 0x56, 0x46, 0x21 }; // OVF!
+            const size_t kHeaderSize = sizeof(kMagic) + sizeof(uint64_t);
+
+            using google::protobuf::io::CodedInputStream;
+            using google::protobuf::internal::WireFormatLite;
+
+            // Field numbers of open_vector_format.proto.
+            enum VectorBlockField { kMarkingParamsKey = 50 };
+            enum PointsField { kPoints = 1 }; // Also points_with_paras of LineSequenceParaAdapt.
+
+            bool HasPointsField(int data_case) {
+                switch (data_case) {
+                case VectorBlock::kLineSequence:
+                case VectorBlock::kHatches:
+                case VectorBlock::kPointSequence:
+                case VectorBlock::kLineSequence3D:
+                case VectorBlock::kHatches3D:
+                case VectorBlock::kPointSequence3D:
+                case VectorBlock::kLineSequenceParaAdapt:
+                    return true;
+                default:
+                    return false;
+                }
+            }
+
+            bool IsVectorDataField(int field) {
+                return field >= VectorBlock::kLineSequence && field <= VectorBlock::kHatchParaAdapt;
+            }
+
+            bool ReadLengthDelimited(CodedInputStream& input, const uint8_t* start, const uint8_t*& data, size_t& size) {
+                uint32_t length;
+                if (!input.ReadVarint32(&length)) {
+                    return false;
+                }
+                data = start + input.CurrentPosition();
+                size = length;
+                return input.Skip(static_cast<int>(length));
+            }
+
+            /**
+             * Finds the points of a vector data message. They are usually one packed field;
+             * anything else, unpacked floats or a field split in several parts, is flagged
+             * as unusual and left to the full parser.
+             */
+            bool ScanVectorData(const uint8_t* data, size_t size, const uint8_t*& points, size_t& points_bytes, bool& unusual) {
+                CodedInputStream input(data, static_cast<int>(size));
+                points = nullptr;
+                points_bytes = 0;
+                unusual = false;
+                while (const uint32_t tag = input.ReadTag()) {
+                    if (WireFormatLite::GetTagFieldNumber(tag) != kPoints) {
+                        if (!WireFormatLite::SkipField(&input, tag)) {
+                            return false;
+                        }
+                        continue;
+                    }
+                    if (points != nullptr || WireFormatLite::GetTagWireType(tag) != WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+                        unusual = true;
+                        if (!WireFormatLite::SkipField(&input, tag)) {
+                            return false;
+                        }
+                        continue;
+                    }
+                    if (!ReadLengthDelimited(input, data, points, points_bytes) || points_bytes % sizeof(float) != 0) {
+                        return false;
+                    }
+                }
+                return input.ConsumedEntireMessage();
+            }
+        }
+
+        // --- VectorBlockView Implementation ---
+
+        FloatSpan VectorBlockView::Points(std::vector<float>& scratch) const {
+            FloatSpan span;
+            if (m_points_unusual) {
+                VectorBlock block;
+                Parse(block);
+                const google::protobuf::RepeatedField<float>* points = nullptr;
+                switch (block.vector_data_case()) {
+                case VectorBlock::kLineSequence: points = &block.line_sequence().points(); break;
+                case VectorBlock::kHatches: points = &block._hatches().points(); break;
+                case VectorBlock::kPointSequence: points = &block.point_sequence().points(); break;
+                case VectorBlock::kLineSequence3D: points = &block.line_sequence_3d().points(); break;
+                case VectorBlock::kHatches3D: points = &block.hatches_3d().points(); break;
+                case VectorBlock::kPointSequence3D: points = &block.point_sequence_3d().points(); break;
+                case VectorBlock::kLineSequenceParaAdapt: points = &block.line_sequence_para_adapt().points_with_paras(); break;
+                default: break;
+                }
+                if (points != nullptr) {
+                    scratch.assign(points->begin(), points->end());
+                    span.data = scratch.data();
+                    span.size = scratch.size();
+                }
+                return span;
+            }
+            if (m_points_bytes == 0) {
+                return span;
+            }
+
+            span.size = m_points_bytes / sizeof(float);
+            const bool aligned = reinterpret_cast<uintptr_t>(m_points) % alignof(float) == 0;
+            if (aligned && !writer::util::IsSystemBigEndian()) {
+                // Packed floats are little-endian IEEE 754, the in-memory layout of this host.
+                span.data = reinterpret_cast<const float*>(m_points);
+                return span;
+            }
+
+            scratch.resize(span.size);
+            if (writer::util::IsSystemBigEndian()) {
+                for (size_t i = 0; i < span.size; ++i) {
+                    const uint8_t* value = m_points + i * sizeof(float);
+                    const uint32_t bits = static_cast<uint32_t>(value[0]) | static_cast<uint32_t>(value[1]) << 8
+                                          | static_cast<uint32_t>(value[2]) << 16 | static_cast<uint32_t>(value[3]) << 24;
+                    std::memcpy(&scratch[i], &bits, sizeof(float));
+                }
+            }
+            else {
+                std::memcpy(scratch.data(), m_points, m_points_bytes);
+            }
+            span.data = scratch.data();
+            return span;
+        }
+
+        void VectorBlockView::Parse(VectorBlock& block) const {
+            if (!block.ParseFromArray(m_data, static_cast<int>(m_size))) {
+                throw std::runtime_error("Failed to parse VectorBlock");
+            }
+        }
+
+        // --- JobReader Implementation ---
+
+        JobReader::JobReader(const std::string& path)
+            : m_path(path), m_file(path) {
+            if (m_file.Size() < kHeaderSize || std::memcmp(m_file.Data(), kMagic, sizeof(kMagic)) != 0) {
+                throw std::runtime_error("Not an OVF file: " + path);
+            }
+            ParseDelimitedAt(ReadOffsetAt(sizeof(kMagic)), m_job_lut);
+            ParseDelimitedAt(m_job_lut.jobshellposition(), m_job_shell);
+        }
+
+        WorkPlaneReader JobReader::OpenWorkPlane(size_t index) const {
+            if (index >= WorkPlaneCount()) {
+                throw std::out_of_range("Work plane " + std::to_string(index) + " is not in " + m_path);
+            }
+            return WorkPlaneReader(*this, index);
+        }
+
+        uint64_t JobReader::ReadOffsetAt(uint64_t position) const {
+            if (position > m_file.Size() || m_file.Size() - position < sizeof(uint64_t)) {
+                throw std::runtime_error("Offset outside of the file in " + m_path);
+            }
+            return writer::util::DecodeLittleEndian(m_file.Data() + position);
+        }
+
+        void JobReader::LocateDelimitedAt(uint64_t offset, const uint8_t*& data, size_t& size) const {
+            if (offset >= m_file.Size()) {
+                throw std::runtime_error("Message offset outside of the file in " + m_path);
+            }
+            const uint8_t* record = m_file.Data() + offset;
+            const uint64_t available = m_file.Size() - offset;
+
+            // The varint length prefix takes at most 5 bytes.
+            google::protobuf::io::CodedInputStream input(record, static_cast<int>(available < 5 ? available : 5));
+            uint32_t length = 0;
+            if (!input.ReadVarint32(&length) || length > static_cast<uint32_t>(INT_MAX)) {
+                throw std::runtime_error("Corrupt message length in " + m_path);
+            }
+            const uint64_t prefix = static_cast<uint64_t>(input.CurrentPosition());
+            if (available - prefix < length) {
+                throw std::runtime_error("Message extends past the end of " + m_path);
+            }
+            data = record + prefix;
+            size = length;
+        }
+
+        void JobReader::ParseDelimitedAt(uint64_t offset, google::protobuf::MessageLite& message) const {
+            const uint8_t* data;
+            size_t size;
+            LocateDelimitedAt(offset, data, size);
+            // Parses straight from the mapped pages; no file bytes are copied on the way.
+            if (!message.ParseFromArray(data, static_cast<int>(size))) {
+                throw std::runtime_error("Failed to parse " + std::string(message.GetTypeName()) + " in " + m_path);
+            }
+        }
+
+
+        // --- WorkPlaneReader Implementation ---
+
+        WorkPlaneReader::WorkPlaneReader(const JobReader& job, size_t index)
+            : m_job(&job), m_index(index) {
+            // A work plane starts with the offset of its WorkPlaneLUT.
+            const uint64_t position = job.m_job_lut.workplanepositions(static_cast<int>(index));
+            job.ParseDelimitedAt(job.ReadOffsetAt(position), m_wp_lut);
+        }
+
+        void WorkPlaneReader::ReadShell(WorkPlane& shell) const {
+            m_job->ParseDelimitedAt(m_wp_lut.workplaneshellposition(), shell);
+        }
+
+        void WorkPlaneReader::ReadVectorBlock(size_t index, VectorBlock& block) const {
+            if (index >= VectorBlockCount()) {
+                throw std::out_of_range("VectorBlock " + std::to_string(index) + " is not in work plane " + std::to_string(m_index));
+            }
+            m_job->ParseDelimitedAt(m_wp_lut.vectorblockspositions(static_cast<int>(index)), block);
+        }
+
+        VectorBlockView WorkPlaneReader::ViewVectorBlock(size_t index) const {
+            if (index >= VectorBlockCount()) {
+                throw std::out_of_range("VectorBlock " + std::to_string(index) + " is not in work plane " + std::to_string(m_index));
+            }
+            VectorBlockView view;
+            m_job->LocateDelimitedAt(m_wp_lut.vectorblockspositions(static_cast<int>(index)), view.m_data, view.m_size);
+
+            // Only the top level is walked; a oneof member or scalar seen twice keeps the last value.
+            CodedInputStream input(view.m_data, static_cast<int>(view.m_size));
+            const uint8_t* vector_data = nullptr;
+            size_t vector_data_size = 0;
+            bool valid = true;
+            while (valid) {
+                const uint32_t tag = input.ReadTag();
+                if (tag == 0) {
+                    valid = input.ConsumedEntireMessage();
+                    break;
+                }
+                const int field = WireFormatLite::GetTagFieldNumber(tag);
+                const WireFormatLite::WireType type = WireFormatLite::GetTagWireType(tag);
+                if (IsVectorDataField(field) && type == WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+                    view.m_data_case = static_cast<VectorBlock::VectorDataCase>(field);
+                    valid = ReadLengthDelimited(input, view.m_data, vector_data, vector_data_size);
+                }
+                else if (field == kMarkingParamsKey && type == WireFormatLite::WIRETYPE_VARINT) {
+                    uint32_t value;
+                    valid = input.ReadVarint32(&value);
+                    view.m_marking_params_key = static_cast<int32_t>(value);
+                }
+                else {
+                    valid = WireFormatLite::SkipField(&input, tag);
+                }
+            }
+
+            view.m_has_points = HasPointsField(view.m_data_case);
+            if (valid && view.m_has_points) {
+                valid = ScanVectorData(vector_data, vector_data_size, view.m_points, view.m_points_bytes, view.m_points_unusual);
+            }
+            if (!valid) {
+                throw std::runtime_error("Failed to parse VectorBlock " + std::to_string(index) + " of work plane " + std::to_string(m_index) + " in " + m_job->m_path);
+            }
+            return view;
+        }
+    }
+} // namespace open_vector_format::reader
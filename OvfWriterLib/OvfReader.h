@@ -0,0 +1,185 @@
+// OvfWriterLib/OvfReader.h
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "google/protobuf/message_lite.h"
+#include "open_vector_format.pb.h"
+#include "ovf_lut.pb.h"
+#include "MappedFile.h"
+
+namespace open_vector_format {
+    namespace reader {
+
+        class WorkPlaneReader;
+
+        /**
+         * @brief A read-only view of contiguous floats it does not own.
+         */
+        struct FloatSpan {
+            const float* data = nullptr;
+            size_t size = 0;
+
+            const float* begin() const { return data; }
+            const float* end() const { return data + size; }
+            bool empty() const { return size == 0; }
+            float operator[](size_t i) const { return data[i]; }
+        };
+
+        /**
+         * @brief A VectorBlock inside the mapped file, decoded only down to its field boundaries.
+         *
+         * Creating a view reads the tags and length prefixes of the block and of its vector
+         * data, but no values, so the points stay where they are in the file. The view is
+         * valid as long as its JobReader.
+         */
+        class VectorBlockView {
+        public:
+            VectorBlock::VectorDataCase DataCase() const { return m_data_case; }
+            int32_t MarkingParamsKey() const { return m_marking_params_key; }
+
+            // The serialized VectorBlock, without its length prefix.
+            const uint8_t* Data() const { return m_data; }
+            size_t Size() const { return m_size; }
+
+            // Whether the vector data has a points field: the line, hatch and point sequences,
+            // in 2D and 3D, and the parameter-adapted line sequence.
+            bool HasPoints() const { return m_has_points; }
+
+            /**
+             * @brief The packed points of the vector data, coordinates interleaved.
+             *
+             * Points straight into the mapped file whenever it can: on a little-endian host,
+             * with the floats aligned in memory. Otherwise the floats are decoded into scratch
+             * and the span refers to it, so it is valid until scratch changes.
+             * @return The points, or an empty span if the block has none.
+             * @throws std::runtime_error if the block is corrupt.
+             */
+            FloatSpan Points(std::vector<float>& scratch) const;
+
+            /**
+             * @brief Parses the whole block.
+             * @throws std::runtime_error if the block is corrupt.
+             */
+            void Parse(VectorBlock& block) const;
+
+        private:
+            friend class WorkPlaneReader;
+
+            VectorBlockView() = default;
+
+            const uint8_t* m_data = nullptr;
+            size_t m_size = 0;
+            VectorBlock::VectorDataCase m_data_case = VectorBlock::VECTOR_DATA_NOT_SET;
+            int32_t m_marking_params_key = 0;
+            bool m_has_points = false;
+            const uint8_t* m_points = nullptr; // The packed points, when stored as one packed field.
+            size_t m_points_bytes = 0;
+            bool m_points_unusual = false;     // Unpacked or split points; only a full parse reads them right.
+        };
+
+        /**
+         * @brief Random access to an OVF file written by JobWriter.
+         *
+         * The file is memory-mapped. Opening it parses the header, the JobLUT and the Job
+         * shell, and nothing else. Work planes and VectorBlocks are parsed on request,
+         * straight from the mapping at their LUT positions, so the cost of reading one
+         * layer does not depend on the size of the job. All read methods are const and
+         * may be called from several threads at once.
+         */
+        class JobReader {
+        public:
+            /**
+             * @brief Opens an OVF file.
+             * @throws std::runtime_error if the file cannot be mapped or is not a valid OVF file.
+             */
+            explicit JobReader(const std::string& path);
+
+            // The Job message without its work_planes.
+            const Job& JobShell() const { return m_job_shell; }
+            const JobLUT& Lut() const { return m_job_lut; }
+
+            size_t WorkPlaneCount() const { return static_cast<size_t>(m_job_lut.workplanepositions_size()); }
+
+            /**
+             * @brief Opens a work plane by its index in the job, parsing its WorkPlaneLUT.
+             * @throws std::out_of_range if there is no such work plane.
+             * @throws std::runtime_error if the work plane is corrupt.
+             */
+            WorkPlaneReader OpenWorkPlane(size_t index) const;
+
+            // The JobReader owns the mapping that its WorkPlaneReaders read from.
+            JobReader(const JobReader&) = delete;
+            JobReader& operator=(const JobReader&) = delete;
+
+        private:
+            friend class WorkPlaneReader;
+
+            /**
+             * @brief Parses the length-delimited message starting at offset.
+             * @throws std::runtime_error if the record lies outside the file or does not parse.
+             */
+            void ParseDelimitedAt(uint64_t offset, google::protobuf::MessageLite& message) const;
+
+            /**
+             * @brief Finds the message bytes of the length-delimited record starting at offset.
+             * @throws std::runtime_error if the record lies outside the file.
+             */
+            void LocateDelimitedAt(uint64_t offset, const uint8_t*& data, size_t& size) const;
+
+            // Reads the 8-byte little-endian offset stored at position.
+            uint64_t ReadOffsetAt(uint64_t position) const;
+
+            std::string m_path;
+            MappedFile m_file;
+            JobLUT m_job_lut;
+            Job m_job_shell;
+        };
+
+
+        /**
+         * @brief Random access to the VectorBlocks of one work plane.
+         *
+         * Holds the parsed WorkPlaneLUT and a pointer to its JobReader, which must outlive it.
+         */
+        class WorkPlaneReader {
+        public:
+            size_t Index() const { return m_index; }
+            const WorkPlaneLUT& Lut() const { return m_wp_lut; }
+
+            size_t VectorBlockCount() const { return static_cast<size_t>(m_wp_lut.vectorblockspositions_size()); }
+
+            /**
+             * @brief Parses the WorkPlane shell, which has no vector_blocks.
+             * @throws std::runtime_error if the shell is corrupt.
+             */
+            void ReadShell(WorkPlane& shell) const;
+
+            /**
+             * @brief Parses one VectorBlock. Reusing the same block for many calls reuses its buffers.
+             * @throws std::out_of_range if there is no such block.
+             * @throws std::runtime_error if the block is corrupt.
+             */
+            void ReadVectorBlock(size_t index, VectorBlock& block) const;
+
+            /**
+             * @brief Views one VectorBlock without parsing it.
+             * @throws std::out_of_range if there is no such block.
+             * @throws std::runtime_error if the block is corrupt.
+             */
+            VectorBlockView ViewVectorBlock(size_t index) const;
+
+        private:
+            friend class JobReader;
+
+            WorkPlaneReader(const JobReader& job, size_t index);
+
+            const JobReader* m_job; // Does not own it.
+            size_t m_index;
+            WorkPlaneLUT m_wp_lut;
+        };
+    }
+} // namespace open_vector_format::reader
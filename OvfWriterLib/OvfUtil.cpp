@@ -1,8 +1,11 @@
 // OvfWriterLib/OvfUtil.cpp
 
 #include "OvfUtil.h"
+#include "google/protobuf/io/coded_stream.h"
 #include "google/protobuf/util/delimited_message_util.h"
 
+#include <cstring>
+
 namespace open_vector_format {
     namespace writer {
         namespace util {
@@ -13,17 +16,71 @@ namespace open_vector_format {
                 return (*(uint8_t*)&num == 0x01);
             }
 
-            void WriteLittleEndian(uint64_t value, std::ofstream& os) {
+            void EncodeLittleEndian(uint64_t value, uint8_t* out) {
+                if (IsSystemBigEndian()) {
+                    for (size_t i = 0; i < sizeof(uint64_t); ++i) {
+                        out[i] = (value >> (i * 8)) & 0xFF;
+                    }
+                }
+                else {
+                    std::memcpy(out, &value, sizeof(uint64_t));
+                }
+            }
+
+            uint64_t DecodeLittleEndian(const uint8_t* in) {
+                uint64_t value = 0;
                 if (IsSystemBigEndian()) {
-                    uint8_t buf[sizeof(uint64_t)];
                     for (size_t i = 0; i < sizeof(uint64_t); ++i) {
-                        buf[i] = (value >> (i * 8)) & 0xFF;
+                        value |= static_cast<uint64_t>(in[i]) << (i * 8);
                     }
-                    os.write(reinterpret_cast<const char*>(buf), sizeof(uint64_t));
                 }
                 else {
-                    os.write(reinterpret_cast<const char*>(&value), sizeof(uint64_t));
+                    std::memcpy(&value, in, sizeof(uint64_t));
                 }
+                return value;
+            }
+
+            namespace {
+                const uint64_t kHashPrime1 = 0x9E3779B185EBCA87ull;
+                const uint64_t kHashPrime2 = 0xC2B2AE3D27D4EB4Full;
+
+                uint64_t RotateLeft(uint64_t value, int bits) {
+                    return (value << bits) | (value >> (64 - bits));
+                }
+
+                uint64_t HashRound(uint64_t lane, uint64_t word) {
+                    return RotateLeft(lane + word * kHashPrime2, 31) * kHashPrime1;
+                }
+
+                uint64_t LoadWord(const uint8_t* data) {
+                    uint64_t word;
+                    std::memcpy(&word, data, sizeof(word));
+                    return word;
+                }
+            }
+
+            uint64_t HashBytes(const uint8_t* data, size_t size) {
+                // Four independent lanes over 32-byte stripes keep the multipliers busy.
+                uint64_t lanes[4] = { kHashPrime1 + kHashPrime2, kHashPrime2, 0, 0 - kHashPrime1 };
+                size_t i = 0;
+                for (; i + 32 <= size; i += 32) {
+                    for (int lane = 0; lane < 4; ++lane) {
+                        lanes[lane] = HashRound(lanes[lane], LoadWord(data + i + 8 * lane));
+                    }
+                }
+                uint64_t hash = RotateLeft(lanes[0], 1) + RotateLeft(lanes[1], 7) + RotateLeft(lanes[2], 12) + RotateLeft(lanes[3], 18);
+                hash ^= static_cast<uint64_t>(size) * kHashPrime1;
+                for (; i + 8 <= size; i += 8) {
+                    hash = HashRound(hash, LoadWord(data + i));
+                }
+                for (; i < size; ++i) {
+                    hash = RotateLeft(hash ^ (data[i] * kHashPrime1), 11) * kHashPrime2;
+                }
+                // Final avalanche, so every input bit affects every output bit.
+                hash ^= hash >> 33;
+                hash *= kHashPrime2;
+                hash ^= hash >> 29;
+                return hash;
             }
 
             Job CreateJobShell(const Job& full_job) {
@@ -68,6 +125,45 @@ namespace open_vector_format {
                 shell.set_num_blocks(0);
                 return shell;
             }
+
+            float JobLayerThickness(const Job& job) {
+                float thickness = 0.0f;
+                for (const auto& part : job.parts_map()) {
+                    const float part_thickness = part.second.process_strategy().layer_thickness_in_mm();
+                    if (part_thickness <= 0.0f || (thickness != 0.0f && part_thickness != thickness)) {
+                        return 0.0f;
+                    }
+                    thickness = part_thickness;
+                }
+                return thickness;
+            }
+
+            void SetLineSequence(const geometry_contract::FlatLayer& layer, size_t contour, VectorBlock& block) {
+                const int count = static_cast<int>(2 * layer.ContourPointCount(contour));
+                auto* points = block.mutable_line_sequence()->mutable_points();
+                points->Resize(count, 0.0f);
+                if (count > 0) {
+                    std::memcpy(points->mutable_data(), layer.ContourPoints(contour), count * sizeof(float));
+                }
+            }
+
+            void SerializeDelimitedBatch(const VectorBlock* blocks, size_t count, const uint64_t* record_offsets,
+                                         uint8_t* target, WorkerPool* pool) {
+                using google::protobuf::io::CodedOutputStream;
+
+                auto serialize = [&](size_t i) {
+                    uint8_t* record = target + record_offsets[i];
+                    record = CodedOutputStream::WriteVarint32ToArray(static_cast<uint32_t>(blocks[i].GetCachedSize()), record);
+                    blocks[i].SerializeWithCachedSizesToArray(record);
+                };
+                if (pool) {
+                    pool->ParallelFor(count, serialize);
+                    return;
+                }
+                for (size_t i = 0; i < count; ++i) {
+                    serialize(i);
+                }
+            }
         }
     } // namespace util
 } // namespace open_vector_format::writer// OvfWriterLib/OvfUtil.cpp
@@ -2,9 +2,12 @@
 
 #pragma once
 
-#include <fstream>
+#include <cstddef>
 #include <cstdint>
+#include <vector>
 #include "open_vector_format.pb.h"
+#include "GeometryContract.h"
+#include "WorkerPool.h"
 
 namespace open_vector_format {
     namespace writer {
@@ -13,12 +16,29 @@ namespace open_vector_format {
 
     namespace util {
 
+        // Whether the host stores integers most significant byte first.
+        bool IsSystemBigEndian();
+
+        /**
+         * @brief Encodes a 64-bit integer in little-endian byte order.
+         * @param value The integer to encode.
+         * @param out Receives the 8 encoded bytes.
+         */
+        void EncodeLittleEndian(uint64_t value, uint8_t* out);
+
         /**
-         * @brief Writes a 64-bit integer to a stream in little-endian byte order.
-         * @param value The integer to write.
-         * @param os The output stream to write to.
+         * @brief Decodes a 64-bit integer stored in little-endian byte order.
+         * @param in The 8 encoded bytes, at any alignment.
          */
-        void WriteLittleEndian(uint64_t value, std::ofstream& os);
+        uint64_t DecodeLittleEndian(const uint8_t* in);
+
+        /**
+         * @brief Hashes bytes with a fast non-cryptographic hash.
+         *
+         * Meant to spot candidates for a byte comparison, within one process: the value
+         * depends on the host's byte order and may change between versions.
+         */
+        uint64_t HashBytes(const uint8_t* data, size_t size);
 
         /**
          * @brief Creates a "shell" of a Job message, copying all fields except the work_planes.
@@ -33,6 +53,45 @@ namespace open_vector_format {
          * @return A new WorkPlane object containing only the shell data.
          */
         WorkPlane CreateWorkPlaneShell(const WorkPlane& full_wp);
+
+        /**
+         * @brief Finds the layer thickness of a job, which the layers of a repeated WorkPlane are apart.
+         *
+         * A WorkPlane with repeats stands for itself and the repeats layers above it, the k-th
+         * one at z_pos_in_mm + k * layer thickness.
+         * @param job A Job or Job shell.
+         * @return The layer_thickness_in_mm of the process strategies of its parts, or 0 if
+         *         there are no parts or they disagree.
+         */
+        float JobLayerThickness(const Job& job);
+
+        /**
+         * @brief Sets a VectorBlock's LineSequence to one contour of a flat layer.
+         *
+         * FlatLayer stores its points in the OVF packed layout, so the contour is copied in
+         * a single block. Reusing the same VectorBlock for every contour reuses its points
+         * buffer as well. The other fields of the block are left untouched.
+         * @param layer The source layer.
+         * @param contour Index of the contour within the layer.
+         * @param block The VectorBlock to fill.
+         */
+        void SetLineSequence(const geometry_contract::FlatLayer& layer, size_t contour, VectorBlock& block);
+
+        /**
+         * @brief Serializes VectorBlocks as consecutive length-delimited records into one buffer.
+         *
+         * The serialization uses the sizes the blocks cached when they were last measured
+         * with ByteSizeLong(), each of which must be at most INT_MAX. Every record has its own
+         * slot, so the blocks are serialized independently and the result is byte for byte
+         * what writing them one after the other would produce.
+         * @param blocks The blocks to serialize.
+         * @param count Number of blocks.
+         * @param record_offsets Offset of each record in target, ascending from 0.
+         * @param target Receives the records.
+         * @param pool Threads to serialize on, or nullptr for the calling thread only.
+         */
+        void SerializeDelimitedBatch(const VectorBlock* blocks, size_t count, const uint64_t* record_offsets,
+                                     uint8_t* target, WorkerPool* pool);
     }
     } // namespace util
 } // namespace open_vector_format::writer
\ No newline at end of file
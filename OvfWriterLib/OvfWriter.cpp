@@ -2,64 +2,321 @@
 
 #include "OvfWriter.h"
 #include "OvfUtil.h"
-#include "google/protobuf/util/delimited_message_util.h"
+#include "google/protobuf/io/coded_stream.h"
+
+#include <climits>
+#include <cmath>
+#include <cstring>
 
 namespace open_vector_format {
     namespace writer {
 
+        // --- WorkPlaneSegment Implementation ---
+
+        WorkPlaneSegment::WorkPlaneSegment(const WorkPlane& work_plane_shell)
+            : m_work_plane_shell_state(util::CreateWorkPlaneShell(work_plane_shell)) {
+        }
+
+        void WorkPlaneSegment::AppendVectorBlock(const VectorBlock& vb) {
+            using google::protobuf::io::CodedOutputStream;
+
+            if (m_raw_block_open) {
+                throw std::runtime_error("Cannot append a VectorBlock while a LineSequence block is open.");
+            }
+            const size_t size = vb.ByteSizeLong();
+            if (size > static_cast<size_t>(INT_MAX)) {
+                throw std::runtime_error("VectorBlock is too large to be written.");
+            }
+            const size_t offset = m_records.size();
+            m_records.resize(offset + CodedOutputStream::VarintSize32(static_cast<uint32_t>(size)) + size);
+            uint8_t* target = CodedOutputStream::WriteVarint32ToArray(static_cast<uint32_t>(size), m_records.data() + offset);
+            vb.SerializeWithCachedSizesToArray(target);
+
+            m_record_offsets.push_back(offset);
+            m_work_plane_shell_state.set_num_blocks(m_work_plane_shell_state.num_blocks() + 1);
+        }
+
+        void WorkPlaneSegment::BeginLineSequenceBlock(const RawBlockFields& fields) {
+            if (m_raw_block_open) {
+                throw std::runtime_error("A LineSequence block is already open.");
+            }
+            m_line_encoder.Begin(fields);
+            m_raw_block_open = true;
+        }
+
+        void WorkPlaneSegment::AppendPoints(const float* xy, size_t float_count) {
+            if (!m_raw_block_open) {
+                throw std::runtime_error("No LineSequence block is open.");
+            }
+            m_line_encoder.AppendPoints(xy, float_count);
+        }
+
+        void WorkPlaneSegment::EndLineSequenceBlock() {
+            if (!m_raw_block_open) {
+                throw std::runtime_error("No LineSequence block is open.");
+            }
+            m_raw_block_open = false;
+            if (m_line_encoder.BlockSize() > static_cast<size_t>(INT_MAX)) {
+                throw std::runtime_error("VectorBlock is too large to be written.");
+            }
+
+            m_record_offsets.push_back(m_records.size());
+            m_line_encoder.WriteTo([this](const void* data, size_t size) {
+                const uint8_t* bytes = static_cast<const uint8_t*>(data);
+                m_records.insert(m_records.end(), bytes, bytes + size);
+            });
+            m_work_plane_shell_state.set_num_blocks(m_work_plane_shell_state.num_blocks() + 1);
+        }
+
+
         // --- JobWriter Implementation ---
 
-        JobWriter::JobWriter(const std::string& path, const Job& job_shell) {
-            m_stream.open(path, std::ios::binary);
-            if (!m_stream.is_open() || !m_stream.good()) {
+        JobWriter::JobWriter(const std::string& path, const Job& job_shell, const JobWriterOptions& options)
+            : m_path(path),
+            m_options(options),
+            m_stream(path, options.buffer_size, options.async_io, options.buffer_count) {
+            if (!m_stream.IsOpen() || !m_stream.Good()) {
                 throw std::runtime_error("Failed to open file for writing: " + path);
             }
 
             // 1. Write file identifier (magic bytes).
             const char magic[] = { 0x4f, 0x56, 0x46, 0x21 }; // OVF!
-            m_stream.write(magic, sizeof(magic));
+            m_stream.WriteRaw(magic, sizeof(magic));
 
             // 2. Reserve 8 bytes for the JobLUT offset, which we'll write at the end.
-            m_job_lut_offset_pos = m_stream.tellp();
-            util::WriteLittleEndian(0, m_stream); // Placeholder
+            m_job_lut_offset_pos = m_stream.Position();
+            m_stream.WriteLittleEndian(0); // Placeholder
 
             // 3. Initialize internal state from the provided shell.
             m_job_shell_state = util::CreateJobShell(job_shell);
+            m_layer_thickness = util::JobLayerThickness(m_job_shell_state);
         }
 
         JobWriter::~JobWriter() {
             // The destructor ensures finalization, even if an exception occurs.
+            std::lock_guard<std::mutex> lock(m_commit_mutex);
             if (!m_is_finalized) {
                 Finalize();
             }
         }
 
-        void JobWriter::Finalize() {
+        void JobWriter::Close() {
+            // Held throughout, so a CommitWorkPlane racing the close either lands before the
+            // job shell is written or finds the writer finalized and throws.
+            std::lock_guard<std::mutex> lock(m_commit_mutex);
+            if (m_is_finalized) {
+                throw std::runtime_error("JobWriter is already finalized: " + m_path);
+            }
+            if (!Finalize()) {
+                throw std::runtime_error("Failed to write OVF file: " + m_path);
+            }
+        }
+
+        bool JobWriter::Finalize() {
+            // A segment still waiting for a predecessor would leave a gap in the work plane numbers.
+            bool complete = m_pending_segments.empty();
+            m_pending_segments.clear();
+            try {
+                WriteRun();
+            }
+            catch (const std::runtime_error&) {
+                complete = false; // Also called from the destructor, which must not throw.
+            }
+
             // 1. Write the job shell itself.
-            m_job_lut.set_jobshellposition(m_stream.tellp());
-            google::protobuf::util::SerializeDelimitedToOstream(m_job_shell_state, &m_stream);
+            m_job_lut.set_jobshellposition(m_stream.Position());
+            m_stream.WriteDelimited(m_job_shell_state);
 
             // 2. Write the JobLUT.
-            uint64_t job_lut_offset = m_stream.tellp();
-            google::protobuf::util::SerializeDelimitedToOstream(m_job_lut, &m_stream);
+            uint64_t job_lut_offset = m_stream.Position();
+            m_stream.WriteDelimited(m_job_lut);
 
-            // 3. Go back and write the actual offset of the JobLUT.
-            m_stream.seekp(m_job_lut_offset_pos);
-            util::WriteLittleEndian(job_lut_offset, m_stream);
+            // 3. Fill in the actual offset of the JobLUT. Closing the stream applies it
+            //    together with every deferred WorkPlaneLUT offset.
+            m_stream.QueuePatchLittleEndian(m_job_lut_offset_pos, job_lut_offset);
 
-            m_stream.close();
             m_is_finalized = true;
+            return m_stream.Close() && complete;
+        }
+
+        WorkerPool& JobWriter::SerializationPool() {
+            if (!m_serialization_pool) {
+                m_serialization_pool.reset(new WorkerPool(m_options.serialization_threads));
+            }
+            return *m_serialization_pool;
+        }
+
+        google::protobuf::Arena& JobWriter::BlockArena() {
+            if (!m_block_arena) {
+                if (m_arena_block_size == 0) {
+                    m_arena_block_size = m_options.arena_block_size;
+                    m_arena_block.reset(new char[m_arena_block_size]);
+                }
+                google::protobuf::ArenaOptions arena_options;
+                arena_options.initial_block = m_arena_block.get();
+                arena_options.initial_block_size = m_arena_block_size;
+                arena_options.start_block_size = m_arena_block_size / 4;
+                arena_options.max_block_size = m_arena_block_size;
+                m_block_arena.reset(new google::protobuf::Arena(arena_options));
+            }
+            return *m_block_arena;
+        }
+
+        void JobWriter::ResetBlockArena() {
+            if (!m_block_arena) {
+                return;
+            }
+            const uint64_t allocated = m_block_arena->SpaceAllocated();
+            if (allocated <= m_arena_block_size) {
+                m_block_arena->Reset();
+                return;
+            }
+            // The workplane overflowed the first block. Start over with one that holds it, plus
+            // some headroom so a slightly larger workplane does not overflow again.
+            m_block_arena.reset();
+            m_arena_block_size = static_cast<size_t>(allocated + allocated / 4);
+            m_arena_block.reset(new char[m_arena_block_size]);
         }
 
         WorkPlaneWriter JobWriter::AppendWorkPlane(const WorkPlane& work_plane_shell) {
-            if (m_is_finalized) {
-                throw std::runtime_error("Cannot append WorkPlane to a finalized JobWriter.");
+            {
+                std::lock_guard<std::mutex> lock(m_commit_mutex);
+                if (m_is_finalized) {
+                    throw std::runtime_error("Cannot append WorkPlane to a finalized JobWriter.");
+                }
+                // A held run ends here, since WorkPlaneWriters are never merged.
+                WriteRun();
             }
             // The private constructor of WorkPlaneWriter creates the object correctly.
             return WorkPlaneWriter(*this, work_plane_shell);
         }
 
 
+        void JobWriter::CommitWorkPlane(int32_t work_plane_number, WorkPlaneSegment segment) {
+            if (m_options.deduplicate_work_planes) {
+                // Hashed before taking the lock, so committing threads hash in parallel.
+                segment.m_records_hash = util::HashBytes(segment.m_records.data(), segment.m_records.size());
+            }
+
+            if (segment.m_raw_block_open) {
+                throw std::runtime_error("Cannot commit a WorkPlane with an open LineSequence block.");
+            }
+
+            std::lock_guard<std::mutex> lock(m_commit_mutex);
+            if (m_is_finalized) {
+                throw std::runtime_error("Cannot append WorkPlane to a finalized JobWriter.");
+            }
+            if (work_plane_number < m_work_planes_received || m_pending_segments.count(work_plane_number) > 0) {
+                throw std::runtime_error("WorkPlane " + std::to_string(work_plane_number) + " was already committed.");
+            }
+            if (work_plane_number > m_work_planes_received) {
+                m_pending_segments.emplace(work_plane_number, std::move(segment));
+                return;
+            }
+
+            AcceptSegment(segment);
+            // Take every parked segment that has become next in line.
+            auto next = m_pending_segments.begin();
+            while (next != m_pending_segments.end() && next->first == m_work_planes_received) {
+                AcceptSegment(next->second);
+                next = m_pending_segments.erase(next);
+            }
+        }
+
+        void JobWriter::AcceptSegment(WorkPlaneSegment& segment) {
+            ++m_work_planes_received;
+            if (!m_options.deduplicate_work_planes || m_layer_thickness == 0.0) {
+                WriteSegment(segment);
+                return;
+            }
+
+            if (m_has_run && ExtendsRun(segment)) {
+                ++m_run_repeats;
+                return;
+            }
+
+            WriteRun();
+            m_run_head = std::move(segment);
+            m_has_run = true;
+            m_run_repeats = 0;
+        }
+
+        bool JobWriter::ExtendsRun(const WorkPlaneSegment& segment) const {
+            const WorkPlane& head = m_run_head.m_work_plane_shell_state;
+            const WorkPlane& next = segment.m_work_plane_shell_state;
+            // A shell that already repeats is left as its caller made it.
+            if (head.repeats() != 0 || next.repeats() != 0 || m_run_repeats == UINT32_MAX) {
+                return false;
+            }
+
+            // A reader puts the next repeat one layer thickness above the last, so the layer
+            // must lie there. Heights are computed in floating point, so a thousandth of a
+            // layer off still counts as there.
+            const double expected_z = head.z_pos_in_mm() + (m_run_repeats + 1.0) * m_layer_thickness;
+            if (std::fabs(next.z_pos_in_mm() - expected_z) > 1.0e-3 * m_layer_thickness) {
+                return false;
+            }
+
+            // The hash rules out almost every mismatch before the bytes are compared.
+            if (segment.m_records_hash != m_run_head.m_records_hash || segment.m_records.size() != m_run_head.m_records.size()
+                || std::memcmp(segment.m_records.data(), m_run_head.m_records.data(), segment.m_records.size()) != 0) {
+                return false;
+            }
+
+            WorkPlane head_rest = head;
+            WorkPlane next_rest = next;
+            head_rest.clear_z_pos_in_mm();
+            next_rest.clear_z_pos_in_mm();
+            head_rest.clear_work_plane_number(); // Assigned when written.
+            next_rest.clear_work_plane_number();
+            return head_rest.SerializeAsString() == next_rest.SerializeAsString();
+        }
+
+        void JobWriter::WriteRun() {
+            if (!m_has_run) {
+                return;
+            }
+            m_has_run = false;
+            m_run_head.m_work_plane_shell_state.set_repeats(m_run_repeats);
+            WriteSegment(m_run_head);
+            m_run_head = WorkPlaneSegment(); // Releases the records.
+        }
+
+        void JobWriter::WriteSegment(WorkPlaneSegment& segment) {
+            using google::protobuf::io::CodedOutputStream;
+
+            // The segment is written as [WorkPlaneLUT offset][VectorBlocks][WorkPlane shell][WorkPlaneLUT],
+            // exactly like a WorkPlaneWriter. Its records are relocated by the position it lands at.
+            const uint64_t base = m_stream.Position();
+            const uint64_t records_start = base + sizeof(uint64_t);
+            const uint64_t shell_position = records_start + segment.m_records.size();
+
+            WorkPlane& shell = segment.m_work_plane_shell_state;
+            shell.set_work_plane_number(m_job_shell_state.num_work_planes());
+            const size_t shell_size = shell.ByteSizeLong();
+            const uint64_t wp_lut_offset = shell_position + CodedOutputStream::VarintSize32(static_cast<uint32_t>(shell_size)) + shell_size;
+
+            WorkPlaneLUT wp_lut;
+            wp_lut.mutable_vectorblockspositions()->Reserve(static_cast<int>(segment.m_record_offsets.size()));
+            for (uint64_t offset : segment.m_record_offsets) {
+                wp_lut.add_vectorblockspositions(records_start + offset);
+            }
+            wp_lut.set_workplaneshellposition(shell_position);
+
+            // Everything is known up front, so the LUT offset needs no patch.
+            m_job_lut.add_workplanepositions(base);
+            m_stream.WriteLittleEndian(wp_lut_offset);
+            m_stream.WriteRaw(segment.m_records.data(), segment.m_records.size());
+            m_stream.WriteDelimited(shell);
+            m_stream.WriteDelimited(wp_lut);
+            if (!m_stream.Good()) {
+                throw std::runtime_error("Failed to write WorkPlane to the output file.");
+            }
+
+            m_job_shell_state.set_num_work_planes(m_job_shell_state.num_work_planes() + 1);
+        }
+
+
         // --- WorkPlaneWriter Implementation ---
 
         WorkPlaneWriter::WorkPlaneWriter(JobWriter& parent_writer, const WorkPlane& work_plane_shell)
@@ -68,11 +325,11 @@ namespace open_vector_format {
             auto& stream = m_parent_writer->m_stream;
 
             // 1. Record the start position of this WorkPlane block in the JobLUT.
-            m_parent_writer->m_job_lut.add_workplanepositions(stream.tellp());
+            m_parent_writer->m_job_lut.add_workplanepositions(stream.Position());
 
             // 2. Reserve 8 bytes for the WorkPlaneLUT offset.
-            m_wp_lut_offset_pos = stream.tellp();
-            util::WriteLittleEndian(0, stream); // Placeholder
+            m_wp_lut_offset_pos = stream.Position();
+            stream.WriteLittleEndian(0); // Placeholder
 
             // 3. Initialize internal state.
             m_work_plane_shell_state = util::CreateWorkPlaneShell(work_plane_shell);
@@ -84,6 +341,9 @@ namespace open_vector_format {
             // Destructor ensures finalization. If the writer is moved, this logic won't run
             // on the moved-from object because m_parent_writer will be null.
             if (!m_is_finalized && m_parent_writer) {
+                // A destructor must not throw, so a block left open, e.g. by an exception
+                // between its points, is dropped rather than reported.
+                m_raw_block_open = false;
                 Finalize();
             }
         }
@@ -92,36 +352,168 @@ namespace open_vector_format {
             if (m_is_finalized) {
                 throw std::runtime_error("Cannot append VectorBlock to a finalized WorkPlaneWriter.");
             }
+            if (m_raw_block_open) {
+                throw std::runtime_error("Cannot append a VectorBlock while a LineSequence block is open.");
+            }
+            auto& stream = m_parent_writer->m_stream;
+
+            m_wp_lut.add_vectorblockspositions(stream.Position());
+            stream.WriteDelimited(vb);
+            // With async_io this only covers serialization; disk errors are reported by JobWriter::Close().
+            if (!stream.Good()) {
+                throw std::runtime_error("Failed to write VectorBlock to the output file.");
+            }
+
+            m_work_plane_shell_state.set_num_blocks(m_work_plane_shell_state.num_blocks() + 1);
+        }
+
+        void WorkPlaneWriter::BeginLineSequenceBlock(const RawBlockFields& fields) {
+            if (m_is_finalized) {
+                throw std::runtime_error("Cannot append VectorBlock to a finalized WorkPlaneWriter.");
+            }
+            if (m_raw_block_open) {
+                throw std::runtime_error("A LineSequence block is already open.");
+            }
+            m_parent_writer->m_line_encoder.Begin(fields);
+            m_raw_block_open = true;
+        }
+
+        void WorkPlaneWriter::AppendPoints(const float* xy, size_t float_count) {
+            if (!m_raw_block_open) {
+                throw std::runtime_error("No LineSequence block is open.");
+            }
+            m_parent_writer->m_line_encoder.AppendPoints(xy, float_count);
+        }
+
+        void WorkPlaneWriter::EndLineSequenceBlock() {
+            if (!m_raw_block_open) {
+                throw std::runtime_error("No LineSequence block is open.");
+            }
+            m_raw_block_open = false;
+            const LineSequenceEncoder& encoder = m_parent_writer->m_line_encoder;
+            if (encoder.BlockSize() > static_cast<size_t>(INT_MAX)) {
+                throw std::runtime_error("VectorBlock is too large to be written.");
+            }
             auto& stream = m_parent_writer->m_stream;
 
-            m_wp_lut.add_vectorblockspositions(stream.tellp());
-            google::protobuf::util::SerializeDelimitedToOstream(vb, &stream);
+            m_wp_lut.add_vectorblockspositions(stream.Position());
+            encoder.WriteTo([&stream](const void* data, size_t size) { stream.WriteRaw(data, size); });
+            if (!stream.Good()) {
+                throw std::runtime_error("Failed to write VectorBlock to the output file.");
+            }
 
             m_work_plane_shell_state.set_num_blocks(m_work_plane_shell_state.num_blocks() + 1);
         }
 
+        VectorBlock* WorkPlaneWriter::CreateVectorBlock() {
+            if (m_is_finalized) {
+                throw std::runtime_error("Cannot append VectorBlock to a finalized WorkPlaneWriter.");
+            }
+            if (m_raw_block_open) {
+                throw std::runtime_error("Cannot append a VectorBlock while a LineSequence block is open.");
+            }
+            return google::protobuf::Arena::Create<VectorBlock>(&m_parent_writer->BlockArena());
+        }
+
+        void WorkPlaneWriter::AppendVectorBlocks(const VectorBlock* blocks, size_t count) {
+            if (m_is_finalized) {
+                throw std::runtime_error("Cannot append VectorBlock to a finalized WorkPlaneWriter.");
+            }
+            if (m_raw_block_open) {
+                throw std::runtime_error("Cannot append a VectorBlock while a LineSequence block is open.");
+            }
+            using google::protobuf::io::CodedOutputStream;
+            JobWriter& parent = *m_parent_writer;
+            auto& stream = parent.m_stream;
+
+            // 1. Measure every block once. Everything below writes with the cached sizes.
+            std::vector<uint64_t>& record_sizes = parent.m_batch_sizes;
+            record_sizes.resize(count);
+            uint64_t total = 0;
+            for (size_t i = 0; i < count; ++i) {
+                const size_t size = blocks[i].ByteSizeLong();
+                if (size > static_cast<size_t>(INT_MAX)) {
+                    throw std::runtime_error("VectorBlock is too large to be written.");
+                }
+                record_sizes[i] = CodedOutputStream::VarintSize32(static_cast<uint32_t>(size)) + size;
+                total += record_sizes[i];
+            }
+            WorkerPool* pool = nullptr;
+            if (count >= 2 && parent.m_options.serialization_threads != 1 && total >= parent.m_options.parallel_serialization_min_bytes) {
+                pool = &parent.SerializationPool();
+            }
+
+            // 2. Serialize the blocks straight into the output buffer, as many at a time as fit
+            //    into one buffer. A block larger than a whole buffer is split across buffers by
+            //    the stream instead.
+            std::vector<uint64_t>& record_offsets = parent.m_batch_offsets;
+            size_t first = 0;
+            while (first < count) {
+                const uint64_t room = record_sizes[first] <= stream.Room() ? stream.Room() : stream.BufferSize();
+                size_t end = first;
+                uint64_t bytes = 0;
+                record_offsets.clear();
+                while (end < count && bytes + record_sizes[end] <= room) {
+                    record_offsets.push_back(bytes);
+                    bytes += record_sizes[end++];
+                }
+
+                const uint64_t base = stream.Position();
+                if (end == first) {
+                    m_wp_lut.add_vectorblockspositions(base);
+                    stream.WriteDelimitedWithCachedSize(blocks[first]);
+                    ++first;
+                }
+                else {
+                    uint8_t* target = stream.Claim(static_cast<size_t>(bytes));
+                    if (!target) {
+                        throw std::runtime_error("Failed to write VectorBlock to the output file.");
+                    }
+                    for (uint64_t offset : record_offsets) {
+                        m_wp_lut.add_vectorblockspositions(base + offset);
+                    }
+                    util::SerializeDelimitedBatch(blocks + first, end - first, record_offsets.data(), target, pool);
+                    first = end;
+                }
+                if (!stream.Good()) {
+                    throw std::runtime_error("Failed to write VectorBlock to the output file.");
+                }
+            }
+
+            m_work_plane_shell_state.set_num_blocks(m_work_plane_shell_state.num_blocks() + static_cast<int32_t>(count));
+        }
+
         void WorkPlaneWriter::Finalize() {
+            if (m_raw_block_open) {
+                throw std::runtime_error("Cannot finalize a WorkPlane while a LineSequence block is open.");
+            }
             auto& stream = m_parent_writer->m_stream;
 
             // 1. Write the WorkPlane shell.
-            m_wp_lut.set_workplaneshellposition(stream.tellp());
-            google::protobuf::util::SerializeDelimitedToOstream(m_work_plane_shell_state, &stream);
+            m_wp_lut.set_workplaneshellposition(stream.Position());
+            stream.WriteDelimited(m_work_plane_shell_state);
 
             // 2. Write the WorkPlaneLUT.
-            uint64_t wp_lut_offset = stream.tellp();
-            google::protobuf::util::SerializeDelimitedToOstream(m_wp_lut, &stream);
+            uint64_t wp_lut_offset = stream.Position();
+            stream.WriteDelimited(m_wp_lut);
 
-            // 3. Go back and write the actual offset of the WorkPlaneLUT.
-            stream.seekp(m_wp_lut_offset_pos);
-            util::WriteLittleEndian(wp_lut_offset, stream);
-
-            // 4. Seek back to the end of the file to be ready for the next WorkPlane.
-            stream.seekp(0, std::ios::end);
+            // 3. Fill in the actual offset of the WorkPlaneLUT, either now or in the
+            //    patch pass of JobWriter::Finalize.
+            if (m_parent_writer->m_options.defer_offset_patches) {
+                stream.QueuePatchLittleEndian(m_wp_lut_offset_pos, wp_lut_offset);
+            }
+            else {
+                stream.PatchLittleEndian(m_wp_lut_offset_pos, wp_lut_offset);
+            }
 
-            // 5. Update the parent's work plane count.
+            // 4. Update the parent's work plane count.
             m_parent_writer->m_job_shell_state.set_num_work_planes(
                 m_parent_writer->m_job_shell_state.num_work_planes() + 1
             );
+            ++m_parent_writer->m_work_planes_received;
+
+            // 5. Every block created on the arena for this workplane is written by now.
+            m_parent_writer->ResetBlockArena();
 
             m_is_finalized = true;
         }
@@ -134,7 +526,8 @@ namespace open_vector_format {
             m_work_plane_shell_state(std::move(other.m_work_plane_shell_state)),
             m_wp_lut(std::move(other.m_wp_lut)),
             m_wp_lut_offset_pos(other.m_wp_lut_offset_pos),
-            m_is_finalized(other.m_is_finalized)
+            m_is_finalized(other.m_is_finalized),
+            m_raw_block_open(other.m_raw_block_open)
         {
             // The moved-from object is now inert and its destructor will do nothing.
             other.m_parent_writer = nullptr;
@@ -145,6 +538,7 @@ namespace open_vector_format {
             if (this != &other) {
                 // Finalize the current object before overwriting it, if necessary.
                 if (!m_is_finalized && m_parent_writer) {
+                    m_raw_block_open = false; // Dropped, as in the destructor.
                     Finalize();
                 }
 
@@ -153,6 +547,7 @@ namespace open_vector_format {
                 m_wp_lut = std::move(other.m_wp_lut);
                 m_wp_lut_offset_pos = other.m_wp_lut_offset_pos;
                 m_is_finalized = other.m_is_finalized;
+                m_raw_block_open = other.m_raw_block_open;
 
                 other.m_parent_writer = nullptr;
                 other.m_is_finalized = true;
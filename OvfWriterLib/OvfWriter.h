@@ -3,12 +3,19 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include <fstream>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <stdexcept>
+#include "google/protobuf/arena.h"
 #include "open_vector_format.pb.h"
 #include "ovf_lut.pb.h"
 #include "GeometryContract.h"
+#include "LineSequenceEncoder.h"
+#include "OvfOutputStream.h"
+#include "WorkerPool.h"
 
 namespace open_vector_format {
     namespace writer {
@@ -16,6 +23,89 @@ namespace open_vector_format {
         // Forward-declare WorkPlaneWriter so JobWriter can use it.
         class WorkPlaneWriter;
 
+        /**
+         * @brief Tuning knobs of a JobWriter.
+         */
+        struct JobWriterOptions {
+            // Size of the write buffer in front of the file. Messages are serialized straight
+            // into it, and it goes to disk in one write whenever it is full.
+            size_t buffer_size = 4 * 1024 * 1024;
+            // Keep the WorkPlaneLUT offsets in memory and write them in one pass when the job
+            // is finalized, so the file is written strictly sequentially until then. When
+            // false, each WorkPlane seeks back and patches its offset as soon as it is done.
+            bool defer_offset_patches = true;
+            // Write full buffers on a dedicated I/O thread, so serialization continues in the
+            // next buffer while the disk is busy. AppendVectorBlock blocks only when all
+            // buffer_count buffers are waiting to be written. A failed disk write is then
+            // reported by Close() instead of by whichever AppendVectorBlock happens to run
+            // after it, which keeps the failing call independent of thread timing.
+            bool async_io = false;
+            // Buffers of buffer_size bytes used by async_io, at least 2.
+            size_t buffer_count = 2;
+            // Threads serializing a batch passed to AppendVectorBlocks, started with the first
+            // batch and kept until the writer is destroyed. 0 uses every logical processor.
+            size_t serialization_threads = 0;
+            // Batches smaller than this many bytes are serialized on the calling thread, where
+            // waking the threads would cost more than it saves.
+            size_t parallel_serialization_min_bytes = 256 * 1024;
+            // Initial size of the arena behind WorkPlaneWriter::CreateVectorBlock. The arena
+            // grows to the largest workplane seen, after which workplanes allocate nothing.
+            size_t arena_block_size = 1024 * 1024;
+            // Collapse runs of identical WorkPlanes committed through CommitWorkPlane into the
+            // first of them, with WorkPlane.repeats counting the layers that follow it. Layers
+            // of a run have the same VectorBlocks and shell, apart from z_pos_in_mm, which rises
+            // by exactly the job's layer thickness (util::JobLayerThickness) from each layer to
+            // the next, so a reader recovers every height from the file. A job shell without a
+            // layer thickness in its parts' process strategies is written without merging.
+            // Layers written through a WorkPlaneWriter are never merged, since their blocks are
+            // on their way to disk before they could be compared.
+            bool deduplicate_work_planes = false;
+        };
+
+        /**
+         * @brief A WorkPlane serialized into memory, independent of any JobWriter.
+         *
+         * Segments can be filled on any number of threads at once, since the file offsets
+         * of their records are only fixed when JobWriter::CommitWorkPlane relocates them.
+         */
+        class WorkPlaneSegment {
+        public:
+            /**
+             * @param work_plane_shell A WorkPlane message with its metadata.
+             *                         Any vector_blocks will be ignored.
+             */
+            explicit WorkPlaneSegment(const WorkPlane& work_plane_shell = WorkPlane());
+
+            /**
+             * @brief Serializes a VectorBlock into the segment.
+             * @throws std::runtime_error if the block is too large for a delimited record.
+             */
+            void AppendVectorBlock(const VectorBlock& vb);
+
+            /**
+             * @brief Raw LineSequence emission, see WorkPlaneWriter::BeginLineSequenceBlock.
+             *
+             * Appending a VectorBlock or committing the segment while a block is open throws.
+             */
+            void BeginLineSequenceBlock(const RawBlockFields& fields = RawBlockFields());
+            void AppendPoints(const float* xy, size_t float_count);
+            void EndLineSequenceBlock();
+
+            // Bytes of the serialized VectorBlocks.
+            size_t ByteSize() const { return m_records.size(); }
+            bool IsEmpty() const { return m_record_offsets.empty(); }
+
+        private:
+            friend class JobWriter;
+
+            WorkPlane m_work_plane_shell_state;
+            std::vector<uint8_t> m_records;         // Length-delimited VectorBlocks, back to back.
+            std::vector<uint64_t> m_record_offsets; // Offset of each record within m_records.
+            LineSequenceEncoder m_line_encoder;
+            bool m_raw_block_open = false;
+            uint64_t m_records_hash = 0; // Set when committed to a deduplicating JobWriter.
+        };
+
         /**
          * @brief Manages the top-level scope of writing an OVF file.
          *
@@ -30,8 +120,9 @@ namespace open_vector_format {
              * @param path The path to the output .ovf file.
              * @param job_shell A Job protobuf message containing all metadata. Any
              *                  work_planes within this message will be ignored.
+             * @param options Buffering of the output file.
              */
-            JobWriter(const std::string& path, const Job& job_shell);
+            JobWriter(const std::string& path, const Job& job_shell, const JobWriterOptions& options = JobWriterOptions());
 
             /**
              * @brief Finalizes and closes the OVF file.
@@ -46,6 +137,28 @@ namespace open_vector_format {
              */
             WorkPlaneWriter AppendWorkPlane(const WorkPlane& work_plane_shell);
 
+            /**
+             * @brief Writes a WorkPlane that was serialized on its own, relocating its offsets.
+             *
+             * Thread-safe, so segments can be committed straight from the threads that built
+             * them. A segment arriving before its predecessors is kept until they are written.
+             * Do not mix with a WorkPlaneWriter that is active at the same time.
+             * With deduplicate_work_planes, the last WorkPlane is held back until a different
+             * one arrives or the job is finalized, so that its repeats are known when it is written.
+             * @param work_plane_number Position of the WorkPlane in the job. Numbers must be
+             *        consecutive, counting the WorkPlanes appended through AppendWorkPlane and
+             *        those merged into a repeat.
+             * @param segment The WorkPlane to write.
+             * @throws std::runtime_error if the number is already taken or the file could not be written.
+             */
+            void CommitWorkPlane(int32_t work_plane_number, WorkPlaneSegment segment);
+
+            /**
+             * @brief Finalizes and closes the OVF file now, reporting errors the destructor has to swallow.
+             * @throws std::runtime_error if any part of the file could not be written.
+             */
+            void Close();
+
             // This class manages a file handle, so it should not be copied or moved.
             JobWriter(const JobWriter&) = delete;
             JobWriter& operator=(const JobWriter&) = delete;
@@ -54,13 +167,57 @@ namespace open_vector_format {
             // Grant WorkPlaneWriter access to our private members, like the stream.
             friend class WorkPlaneWriter;
 
-            void Finalize();
+            // Writes the job shell and LUT and closes the stream. Returns false on a write error.
+            // Requires m_commit_mutex.
+            bool Finalize();
 
-            std::ofstream m_stream;
+            std::string m_path;
+            JobWriterOptions m_options;
+            OvfOutputStream m_stream;
             Job m_job_shell_state;
             JobLUT m_job_lut;
-            std::streampos m_job_lut_offset_pos; // The position where the offset to the JobLUT is stored.
+            uint64_t m_job_lut_offset_pos; // The position where the offset to the JobLUT is stored.
             bool m_is_finalized = false;
+
+            // Scratch space of AppendVectorBlocks, kept to reuse its allocation.
+            std::vector<uint64_t> m_batch_sizes;
+            std::vector<uint64_t> m_batch_offsets;
+
+            // Returns the threads of AppendVectorBlocks, starting them on first use.
+            WorkerPool& SerializationPool();
+            std::unique_ptr<WorkerPool> m_serialization_pool;
+
+            // Raw LineSequence emission of the active WorkPlaneWriter, kept to reuse its span list.
+            LineSequenceEncoder m_line_encoder;
+
+            // Returns the arena of the active WorkPlaneWriter, creating it on first use.
+            google::protobuf::Arena& BlockArena();
+            // Frees every block of the finished workplane. If the arena had to grow, its first
+            // block is enlarged to fit, so the next workplane of that size needs no allocation.
+            void ResetBlockArena();
+
+            std::unique_ptr<char[]> m_arena_block; // The arena's first block, owned here to survive resets.
+            size_t m_arena_block_size = 0;
+            std::unique_ptr<google::protobuf::Arena> m_block_arena;
+
+            // Writes one segment at the current position. Requires m_commit_mutex.
+            void WriteSegment(WorkPlaneSegment& segment);
+            // Takes the next segment in order, merging or writing it. Requires m_commit_mutex.
+            void AcceptSegment(WorkPlaneSegment& segment);
+            // Whether segment continues the run of m_run_head. Requires m_commit_mutex.
+            bool ExtendsRun(const WorkPlaneSegment& segment) const;
+            // Writes the held run head, if any, with its repeats. Requires m_commit_mutex.
+            void WriteRun();
+
+            std::mutex m_commit_mutex;
+            std::map<int32_t, WorkPlaneSegment> m_pending_segments; // Committed ahead of their predecessors.
+            int32_t m_work_planes_received = 0; // Work planes taken in order, merged ones included.
+
+            // The run of identical WorkPlanes being collected by deduplicate_work_planes.
+            WorkPlaneSegment m_run_head;
+            bool m_has_run = false;
+            uint32_t m_run_repeats = 0;
+            double m_layer_thickness = 0.0; // The step between repeats, recorded in the job shell.
         };
 
 
@@ -76,9 +233,59 @@ namespace open_vector_format {
             /**
              * @brief Appends a VectorBlock to the current WorkPlane.
              * @param vb The VectorBlock to write.
+             * @throws std::runtime_error if the output file could not be written.
              */
             void AppendVectorBlock(const VectorBlock& vb);
 
+            /**
+             * @brief Appends several VectorBlocks to the current WorkPlane, serializing them in parallel.
+             *
+             * Each block is measured once and serialized in place into the output buffer, on the
+             * JobWriter's serialization threads. The file content is identical to calling
+             * AppendVectorBlock for each block in order.
+             * @param blocks The VectorBlocks to write.
+             * @param count Number of blocks.
+             * @throws std::runtime_error if the output file could not be written.
+             */
+            void AppendVectorBlocks(const VectorBlock* blocks, size_t count);
+            void AppendVectorBlocks(const std::vector<VectorBlock>& blocks) { AppendVectorBlocks(blocks.data(), blocks.size()); }
+
+            /**
+             * @brief Starts a LineSequence VectorBlock that is encoded without building the message.
+             *
+             * Points given to AppendPoints are referenced until EndLineSequenceBlock encodes the
+             * block straight into the output buffer, in exactly the bytes AppendVectorBlock would
+             * write for the equivalent VectorBlock. No other block may be created or appended in
+             * between. A WorkPlaneWriter destroyed with a block still open drops that block.
+             * @param fields The block's fields besides its points.
+             * @throws std::runtime_error if a block is already open.
+             */
+            void BeginLineSequenceBlock(const RawBlockFields& fields = RawBlockFields());
+
+            /**
+             * @brief Adds points to the open LineSequence block.
+             * @param xy float_count floats, interleaved x and y. Must stay valid until EndLineSequenceBlock.
+             * @throws std::runtime_error if no block is open.
+             */
+            void AppendPoints(const float* xy, size_t float_count);
+
+            /**
+             * @brief Writes the open LineSequence block.
+             * @throws std::runtime_error if the output file could not be written.
+             */
+            void EndLineSequenceBlock();
+
+            /**
+             * @brief Creates an empty VectorBlock on an arena shared by the whole job.
+             *
+             * Building blocks this way costs no heap allocation per block or field: the arena
+             * is reset when this WorkPlaneWriter finalizes and keeps its memory for the next
+             * workplane. Append the block with AppendVectorBlock as usual.
+             * @return A block owned by the arena. It must not be deleted, and it becomes
+             *         invalid when this WorkPlaneWriter finalizes.
+             */
+            VectorBlock* CreateVectorBlock();
+
             // --- RAII and Move Semantics ---
             // The destructor is where the magic happens for finalizing the WorkPlane.
             ~WorkPlaneWriter();
@@ -102,8 +309,9 @@ namespace open_vector_format {
             JobWriter* m_parent_writer; // Pointer to the parent, does not own it.
             WorkPlane m_work_plane_shell_state;
             WorkPlaneLUT m_wp_lut;
-            std::streampos m_wp_lut_offset_pos; // Position where the offset to the WorkPlaneLUT is stored.
+            uint64_t m_wp_lut_offset_pos; // Position where the offset to the WorkPlaneLUT is stored.
             bool m_is_finalized = false;
+            bool m_raw_block_open = false;
         };
 
     }
@@ -0,0 +1,79 @@
+// OvfWriterLib/WorkerPool.cpp
+
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+namespace open_vector_format {
+    namespace writer {
+
+        WorkerPool::WorkerPool(size_t threads) {
+            if (threads == 0) {
+                threads = std::max(1u, std::thread::hardware_concurrency());
+            }
+            for (size_t t = 1; t < threads; ++t) {
+                m_workers.emplace_back(&WorkerPool::WorkerLoop, this);
+            }
+        }
+
+        WorkerPool::~WorkerPool() {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stop = true;
+            }
+            m_start.notify_all();
+            for (auto& worker : m_workers) {
+                worker.join();
+            }
+        }
+
+        void WorkerPool::ParallelFor(size_t count, const std::function<void(size_t)>& task) {
+            if (m_workers.empty() || count < 2) {
+                for (size_t i = 0; i < count; ++i) {
+                    task(i);
+                }
+                return;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_task = &task;
+                m_count = count;
+                m_next = 0;
+                m_busy = m_workers.size();
+                ++m_loop;
+            }
+            m_start.notify_all();
+            RunIterations();
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_done.wait(lock, [this] { return m_busy == 0; });
+            m_task = nullptr;
+        }
+
+        void WorkerPool::WorkerLoop() {
+            uint64_t joined = 0;
+            for (;;) {
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_start.wait(lock, [&] { return m_stop || m_loop != joined; });
+                    if (m_stop) {
+                        return;
+                    }
+                    joined = m_loop;
+                }
+                RunIterations();
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (--m_busy == 0) {
+                    m_done.notify_one();
+                }
+            }
+        }
+
+        void WorkerPool::RunIterations() {
+            for (size_t i = m_next++; i < m_count; i = m_next++) {
+                (*m_task)(i);
+            }
+        }
+    }
+} // namespace open_vector_format::writer
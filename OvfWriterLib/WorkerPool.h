@@ -0,0 +1,61 @@
+// OvfWriterLib/WorkerPool.h
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace open_vector_format {
+    namespace writer {
+
+        /**
+         * @brief Threads that run the iterations of a loop together with the calling thread.
+         *
+         * The threads are started once and sleep between loops, so a loop costs two wake-ups
+         * instead of starting and joining threads. One loop runs at a time.
+         */
+        class WorkerPool {
+        public:
+            /**
+             * @param threads Threads taking part in a loop, the calling thread included.
+             *                0 uses every logical processor.
+             */
+            explicit WorkerPool(size_t threads);
+            ~WorkerPool();
+
+            size_t ThreadCount() const { return m_workers.size() + 1; }
+
+            /**
+             * @brief Calls task(i) for every i in [0, count) and returns when all calls are done.
+             *
+             * The threads take the iterations one at a time, so they may differ wildly in cost.
+             * @param task Must not throw.
+             */
+            void ParallelFor(size_t count, const std::function<void(size_t)>& task);
+
+            WorkerPool(const WorkerPool&) = delete;
+            WorkerPool& operator=(const WorkerPool&) = delete;
+
+        private:
+            void WorkerLoop();
+            void RunIterations();
+
+            std::vector<std::thread> m_workers;
+            std::mutex m_mutex;
+            std::condition_variable m_start; // A loop was posted, or the pool is stopping.
+            std::condition_variable m_done;  // The last worker left the loop.
+            const std::function<void(size_t)>* m_task = nullptr;
+            size_t m_count = 0;
+            std::atomic<size_t> m_next{ 0 };
+            uint64_t m_loop = 0;   // Counts the loops posted, so each worker joins each loop once.
+            size_t m_busy = 0;     // Workers still in the current loop.
+            bool m_stop = false;
+        };
+    }
+} // namespace open_vector_format::writer
@@ -0,0 +1,196 @@
+#include "AnalyticSectioner.h"
+
+#include <cmath>
+#include <vector>
+
+// --- OCCT Includes ---
+#include <BRep_Tool.hxx>
+#include <BRepAdaptor_Surface.hxx>
+#include <BRepTools.hxx>
+#include <Geom_Curve.hxx>
+#include <Geom_Line.hxx>
+#include <Geom_Surface.hxx>
+#include <Geom2d_Curve.hxx>
+#include <Geom2d_Line.hxx>
+#include <Geom2dAdaptor_Curve.hxx>
+#include <Geom2dHatch_Hatcher.hxx>
+#include <Geom2dHatch_Intersector.hxx>
+#include <HatchGen_Domain.hxx>
+#include <Precision.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Edge.hxx>
+#include <gp_Ax3.hxx>
+#include <gp_Cone.hxx>
+#include <gp_Cylinder.hxx>
+#include <gp_Pln.hxx>
+#include <gp_Sphere.hxx>
+#include <gp_Torus.hxx>
+
+namespace geometry {
+
+    namespace {
+        const double kPi = 3.14159265358979323846;
+        // Revolution axes closer to vertical than this are treated as vertical.
+        const double kAxisTolerance = 1.0e-9;
+
+        // A section line in the face's UV space and the 3D curve sharing its parameter.
+        struct SectionLine {
+            Handle(Geom2d_Line) uv_line;
+            Handle(Geom_Curve) curve;
+        };
+
+        struct SectionPiece {
+            Handle(Geom_Curve) curve;
+            double first;
+            double last;
+        };
+
+        bool IsVertical(const gp_Ax3& position) {
+            return std::abs(std::abs(position.Direction().Z()) - 1.0) < kAxisTolerance;
+        }
+
+        // u runs along the iso-V line, so the clipped parameters apply to VIso(v) unchanged.
+        SectionLine IsoV(const Handle(Geom_Surface)& surface, double v) {
+            return { new Geom2d_Line(gp_Pnt2d(0.0, v), gp_Dir2d(1.0, 0.0)), surface->VIso(v) };
+        }
+
+        // Moves a periodic V parameter into the face's window [v_min, v_min + 2 pi).
+        double IntoPeriod(double v, double v_min) {
+            const double period = 2.0 * kPi;
+            return v - period * std::floor((v - v_min + Precision::PConfusion()) / period);
+        }
+    }
+
+    AnalyticSectioner::AnalyticSectioner(const CurveEmitter& emitter)
+        : m_emitter(emitter) {
+    }
+
+    bool AnalyticSectioner::Section(const TopoDS_Face& face, double z, geometry_contract::SlicedLayer& layer) const {
+
+        const BRepAdaptor_Surface surface(face, Standard_False);
+        std::vector<SectionLine> lines;
+
+        switch (surface.GetType()) {
+        case GeomAbs_Plane: {
+            // P(u, v) = O + u X + v Y, so the plane z = const is the UV line a u + b v = c.
+            const gp_Ax3 position = surface.Plane().Position();
+            const double a = position.XDirection().Z();
+            const double b = position.YDirection().Z();
+            const double c = z - position.Location().Z();
+            const double norm_sq = a * a + b * b;
+            if (norm_sq < kAxisTolerance) {
+                // A horizontal face either lies in the slicing plane, which the boolean
+                // resolves into its boundary, or does not reach it at all.
+                return std::abs(c) > Precision::Confusion();
+            }
+            const gp_Pnt2d origin(a * c / norm_sq, b * c / norm_sq);
+            const gp_Dir2d direction(-b, a);
+            const gp_Vec x_axis(position.XDirection());
+            const gp_Vec y_axis(position.YDirection());
+            const gp_Pnt location = position.Location().Translated(origin.X() * x_axis + origin.Y() * y_axis);
+            const gp_Dir line_direction(direction.X() * x_axis + direction.Y() * y_axis);
+            lines.push_back({ new Geom2d_Line(origin, direction), new Geom_Line(location, line_direction) });
+            break;
+        }
+        case GeomAbs_Cylinder: {
+            const gp_Cylinder cylinder = surface.Cylinder();
+            if (!IsVertical(cylinder.Position())) {
+                return false;
+            }
+            const double v = (z - cylinder.Location().Z()) / cylinder.Axis().Direction().Z();
+            lines.push_back(IsoV(BRep_Tool::Surface(face), v));
+            break;
+        }
+        case GeomAbs_Cone: {
+            const gp_Cone cone = surface.Cone();
+            if (!IsVertical(cone.Position())) {
+                return false;
+            }
+            const double v = (z - cone.Location().Z()) / (std::cos(cone.SemiAngle()) * cone.Axis().Direction().Z());
+            if (std::abs(cone.RefRadius() + v * std::sin(cone.SemiAngle())) < Precision::Confusion()) {
+                return false; // The plane runs through the apex.
+            }
+            lines.push_back(IsoV(BRep_Tool::Surface(face), v));
+            break;
+        }
+        case GeomAbs_Sphere: {
+            const gp_Sphere sphere = surface.Sphere();
+            if (!IsVertical(sphere.Position())) {
+                return false;
+            }
+            const double s = (z - sphere.Location().Z()) / (sphere.Radius() * sphere.Position().Direction().Z());
+            if (std::abs(s) > 1.0 - kAxisTolerance) {
+                return false; // Pole or tangent plane.
+            }
+            lines.push_back(IsoV(BRep_Tool::Surface(face), std::asin(s)));
+            break;
+        }
+        case GeomAbs_Torus: {
+            const gp_Torus torus = surface.Torus();
+            if (!IsVertical(torus.Position())) {
+                return false;
+            }
+            const double s = (z - torus.Location().Z()) / (torus.MinorRadius() * torus.Position().Direction().Z());
+            if (std::abs(s) > 1.0 - kAxisTolerance) {
+                return false; // Tangent to the top or bottom of the tube.
+            }
+            // The plane crosses the tube twice, on the outer and on the inner side.
+            Standard_Real u_min, u_max, v_min, v_max;
+            BRepTools::UVBounds(face, u_min, u_max, v_min, v_max);
+            const double v = std::asin(s);
+            const Handle(Geom_Surface) geom_surface = BRep_Tool::Surface(face);
+            lines.push_back(IsoV(geom_surface, IntoPeriod(v, v_min)));
+            lines.push_back(IsoV(geom_surface, IntoPeriod(kPi - v, v_min)));
+            break;
+        }
+        default:
+            return false;
+        }
+
+        // Clip the lines against the face boundary. Points and segments running along the
+        // boundary are not kept; those belong to the neighbouring face's section.
+        Geom2dHatch_Hatcher hatcher(Geom2dHatch_Intersector(), Precision::PConfusion(), Precision::Confusion(),
+                                    Standard_False, Standard_False);
+
+        const TopoDS_Face forward = TopoDS::Face(face.Oriented(TopAbs_FORWARD));
+        for (TopExp_Explorer explorer(forward, TopAbs_EDGE); explorer.More(); explorer.Next()) {
+            const TopoDS_Edge& edge = TopoDS::Edge(explorer.Current());
+            Standard_Real first, last;
+            const Handle(Geom2d_Curve) pcurve = BRep_Tool::CurveOnSurface(edge, forward, first, last);
+            if (pcurve.IsNull()) {
+                return false;
+            }
+            hatcher.AddElement(Geom2dAdaptor_Curve(pcurve, first, last), edge.Orientation());
+        }
+
+        // The pieces are collected first so a failing line leaves the layer untouched.
+        std::vector<SectionPiece> pieces;
+        for (const auto& line : lines) {
+            if (line.curve.IsNull()) {
+                return false;
+            }
+            const Standard_Integer index = hatcher.AddHatching(Geom2dAdaptor_Curve(line.uv_line));
+            hatcher.Trim(index);
+            if (!hatcher.TrimDone(index) || hatcher.TrimFailed(index)) {
+                return false;
+            }
+            hatcher.ComputeDomains(index);
+            if (!hatcher.IsDone(index)) {
+                return false;
+            }
+            for (Standard_Integer i = 1; i <= hatcher.NbDomains(index); ++i) {
+                const HatchGen_Domain& domain = hatcher.Domain(index, i);
+                if (!domain.HasFirstPoint() || !domain.HasSecondPoint()) {
+                    return false; // An unbounded domain means the boundary is not closed in UV.
+                }
+                pieces.push_back({ line.curve, domain.FirstPoint().Parameter(), domain.SecondPoint().Parameter() });
+            }
+        }
+
+        for (const auto& piece : pieces) {
+            m_emitter.EmitCurve(piece.curve, piece.first, piece.last, layer);
+        }
+        return true;
+    }
+}
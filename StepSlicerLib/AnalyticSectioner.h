@@ -0,0 +1,32 @@
+#pragma once
+#include "GeometryContract.h"
+#include "CurveEmitter.h"
+
+#include <TopoDS_Face.hxx>
+
+namespace geometry {
+
+    /**
+     * @brief Intersects single analytic faces with a horizontal plane in closed form.
+     *
+     * A horizontal plane meets a plane in a line, and a cylinder, cone, sphere or torus
+     * with a vertical axis in one or two iso-V circles. The section is computed directly
+     * in the face's UV space and clipped to the face boundary with a 2D hatcher, so no
+     * boolean operation is involved. Every other surface, tilted revolution axes and
+     * degenerate cases (coplanar faces, poles, cone apices) are left to the caller.
+     */
+    class AnalyticSectioner {
+    public:
+        explicit AnalyticSectioner(const CurveEmitter& emitter);
+
+        /**
+         * @brief Appends the section of the face at height z to the layer.
+         * @return false if the face has to go through the general intersection instead.
+         *         Nothing has been appended to the layer in that case.
+         */
+        bool Section(const TopoDS_Face& face, double z, geometry_contract::SlicedLayer& layer) const;
+
+    private:
+        const CurveEmitter& m_emitter;
+    };
+}
@@ -0,0 +1,165 @@
+#include "ContourAssembler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+
+namespace geometry {
+
+    namespace {
+        // Smallest grid cell, in mm. Smaller tolerances still get a cell this size, so no
+        // coordinate divided by the cell size leaves the range of the cell index.
+        const double kMinCellSize = 1e-9;
+
+        struct CellKey {
+            int64_t x, y;
+            bool operator==(const CellKey& other) const { return x == other.x && y == other.y; }
+        };
+
+        struct CellKeyHash {
+            size_t operator()(const CellKey& key) const {
+                return static_cast<size_t>(static_cast<uint64_t>(key.x) * 0x9E3779B97F4A7C15ULL ^
+                                           static_cast<uint64_t>(key.y) * 0xC2B2AE3D27D4EB4FULL);
+            }
+        };
+
+        double SquaredDistance(const geometry_contract::Point2D& a, const geometry_contract::Point2D& b) {
+            const double dx = a.x - b.x;
+            const double dy = a.y - b.y;
+            return dx * dx + dy * dy;
+        }
+
+        // End point lookup: every piece contributes its head (end 0) and tail (end 1).
+        class EndPointGrid {
+        public:
+            explicit EndPointGrid(double tolerance)
+                : m_tolerance(tolerance), m_cell_size(tolerance > kMinCellSize ? tolerance : kMinCellSize) {}
+
+            void Insert(const geometry_contract::Point2D& p, size_t piece, int end) {
+                m_cells.emplace(Cell(p), Slot{ p, piece, end });
+            }
+
+            // Nearest end point within the tolerance that belongs to an unused piece.
+            bool FindNearest(const geometry_contract::Point2D& p, const std::vector<bool>& used,
+                             size_t& piece, int& end) const {
+                const CellKey center = Cell(p);
+                double best = m_tolerance * m_tolerance;
+                bool found = false;
+                for (int64_t dx = -1; dx <= 1; ++dx) {
+                    for (int64_t dy = -1; dy <= 1; ++dy) {
+                        auto range = m_cells.equal_range(CellKey{ center.x + dx, center.y + dy });
+                        for (auto it = range.first; it != range.second; ++it) {
+                            if (used[it->second.piece]) continue;
+                            const double d = SquaredDistance(p, it->second.point);
+                            if (d <= best) {
+                                best = d;
+                                piece = it->second.piece;
+                                end = it->second.end;
+                                found = true;
+                            }
+                        }
+                    }
+                }
+                return found;
+            }
+
+        private:
+            struct Slot {
+                geometry_contract::Point2D point;
+                size_t piece;
+                int end;
+            };
+
+            CellKey Cell(const geometry_contract::Point2D& p) const {
+                return CellKey{ static_cast<int64_t>(std::floor(p.x / m_cell_size)),
+                                static_cast<int64_t>(std::floor(p.y / m_cell_size)) };
+            }
+
+            double m_tolerance;
+            double m_cell_size; // At least the tolerance, so the 3x3 cells around a point cover it.
+            std::unordered_multimap<CellKey, Slot, CellKeyHash> m_cells;
+        };
+    }
+
+    ContourAssembler::ContourAssembler(double tolerance)
+        : m_tolerance(tolerance > 0.0 ? tolerance : 0.0) {
+    }
+
+    std::vector<geometry_contract::Contour> ContourAssembler::Assemble(std::vector<geometry_contract::Contour>&& pieces) {
+
+        std::vector<geometry_contract::Contour> contours;
+        m_last_open_count = 0;
+        const double tolerance_sq = m_tolerance * m_tolerance;
+
+        std::vector<bool> used(pieces.size(), false);
+        EndPointGrid grid(m_tolerance);
+        for (size_t i = 0; i < pieces.size(); ++i) {
+            auto& points = pieces[i].points;
+            if (points.empty()) {
+                used[i] = true;
+                continue;
+            }
+            // Pieces that already close on themselves (a full circle edge) need no partner.
+            if (pieces[i].closed || (points.size() > 2 && SquaredDistance(points.front(), points.back()) <= tolerance_sq)) {
+                points.back() = points.front();
+                pieces[i].closed = true;
+                contours.push_back(std::move(pieces[i]));
+                used[i] = true;
+                continue;
+            }
+            grid.Insert(points.front(), i, 0);
+            grid.Insert(points.back(), i, 1);
+        }
+
+        // Appends the unused piece closest to the chain's tail, flipped to continue it.
+        auto extend = [&](geometry_contract::Contour& chain) {
+            size_t piece;
+            int end;
+            if (!grid.FindNearest(chain.points.back(), used, piece, end)) {
+                return false;
+            }
+            used[piece] = true;
+            auto& next = pieces[piece].points;
+            if (end == 1) {
+                std::reverse(next.begin(), next.end());
+            }
+            // The matched end point duplicates the chain's tail.
+            chain.points.insert(chain.points.end(), next.begin() + 1, next.end());
+            return true;
+        };
+
+        for (size_t i = 0; i < pieces.size(); ++i) {
+            if (used[i]) {
+                continue;
+            }
+            used[i] = true;
+            geometry_contract::Contour chain = std::move(pieces[i]);
+
+            bool reversed = false;
+            while (true) {
+                if (chain.points.size() > 2 && SquaredDistance(chain.points.front(), chain.points.back()) <= tolerance_sq) {
+                    chain.points.back() = chain.points.front();
+                    chain.closed = true;
+                    break;
+                }
+                if (extend(chain)) {
+                    continue;
+                }
+                // Stuck at the tail: the first piece may sit in the middle of the chain, so grow the head too.
+                if (reversed) {
+                    break;
+                }
+                std::reverse(chain.points.begin(), chain.points.end());
+                reversed = true;
+            }
+
+            if (!chain.closed) {
+                ++m_last_open_count;
+            }
+            contours.push_back(std::move(chain));
+        }
+
+        return contours;
+    }
+}
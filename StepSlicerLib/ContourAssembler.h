@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "GeometryContract.h"
+
+namespace geometry {
+
+    /**
+     * @brief Joins open polylines into loops by matching their end points.
+     *
+     * A section yields one polyline per edge; a circle split into four edges arrives
+     * as four pieces. The assembler chains pieces whose end points lie within the
+     * tolerance of each other, flipping pieces as needed, and marks a chain closed once
+     * its tail meets its head. End points are found through a uniform grid hash with a
+     * cell size of one tolerance, so assembly is linear in the number of pieces.
+     */
+    class ContourAssembler {
+    public:
+        // A tolerance of 0 or less (or NaN) only joins end points that coincide exactly.
+        explicit ContourAssembler(double tolerance);
+
+        /**
+         * @brief Assembles the pieces into as few contours as possible.
+         * @param pieces Polylines in any order and direction. Consumed.
+         * @return The assembled contours. Loops that could not be closed keep
+         *         closed == false, see LastOpenCount().
+         */
+        std::vector<geometry_contract::Contour> Assemble(std::vector<geometry_contract::Contour>&& pieces);
+
+        // Number of contours the last Assemble() call had to leave open.
+        size_t LastOpenCount() const { return m_last_open_count; }
+
+    private:
+        double m_tolerance;
+        size_t m_last_open_count = 0;
+    };
+}
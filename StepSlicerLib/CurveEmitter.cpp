@@ -0,0 +1,155 @@
+#include "CurveEmitter.h"
+
+#include <algorithm>
+#include <cmath>
+
+// --- OCCT Includes ---
+#include <BRep_Tool.hxx>
+#include <Geom_Curve.hxx>
+#include <GeomAdaptor_Curve.hxx>
+#include <GCPnts_UniformDeflection.hxx>
+#include <GCPnts_TangentialDeflection.hxx>
+#include <gp_Circ.hxx>
+#include <gp_Elips.hxx>
+#include <gp_Pnt.hxx>
+
+namespace geometry {
+
+    namespace {
+        const double kRadToDeg = 180.0 / 3.14159265358979323846;
+
+        geometry_contract::Point2D ToPoint2D(const gp_Pnt& p) {
+            return { p.X(), p.Y() };
+        }
+
+        // Conics lying in a horizontal plane run counter-clockwise when their axis points up.
+        double SignedSweep(const gp_Ax1& axis, double first, double last) {
+            const double sweep = (last - first) * kRadToDeg;
+            return axis.Direction().Z() >= 0.0 ? sweep : -sweep;
+        }
+    }
+
+    CurveEmitter::CurveEmitter(CurveEmission mode, const DiscretizationPolicy& policy)
+        : m_mode(mode), m_policy(policy) {
+    }
+
+    void CurveEmitter::Emit(const TopoDS_Edge& edge, geometry_contract::SlicedLayer& layer) const {
+
+        Standard_Real first, last;
+        Handle(Geom_Curve) curve = BRep_Tool::Curve(edge, first, last);
+        if (curve.IsNull()) {
+            return;
+        }
+        EmitCurve(curve, first, last, layer);
+    }
+
+    void CurveEmitter::EmitCurve(const Handle(Geom_Curve)& curve, double first, double last,
+                                 geometry_contract::SlicedLayer& layer) const {
+
+        GeomAdaptor_Curve adaptor(curve, first, last);
+
+        if (m_mode == CurveEmission::Analytic) {
+            switch (adaptor.GetType()) {
+            case GeomAbs_Line: {
+                geometry_contract::Contour segment;
+                segment.points.push_back(ToPoint2D(adaptor.Value(first)));
+                segment.points.push_back(ToPoint2D(adaptor.Value(last)));
+                AppendPolyline(std::move(segment), layer);
+                return;
+            }
+            case GeomAbs_Circle: {
+                const gp_Circ circle = adaptor.Circle();
+                geometry_contract::Arc arc;
+                arc.center = ToPoint2D(circle.Location());
+                arc.start = ToPoint2D(adaptor.Value(first));
+                arc.angle = SignedSweep(circle.Axis(), first, last);
+                layer.arcs.push_back(arc);
+                return;
+            }
+            case GeomAbs_Ellipse: {
+                const gp_Elips ellipse = adaptor.Ellipse();
+                const gp_Dir& major_axis = ellipse.XAxis().Direction();
+                geometry_contract::EllipticArc arc;
+                arc.center = ToPoint2D(ellipse.Location());
+                arc.start = ToPoint2D(adaptor.Value(first));
+                arc.angle = SignedSweep(ellipse.Axis(), first, last);
+                arc.major_radius = ellipse.MajorRadius();
+                arc.minor_radius = ellipse.MinorRadius();
+                arc.rotation = std::atan2(major_axis.Y(), major_axis.X()) * kRadToDeg;
+                layer.ellipses.push_back(arc);
+                return;
+            }
+            default:
+                break;
+            }
+        }
+
+        geometry_contract::Contour contour;
+        if (m_policy.angular_deflection > 0.0) {
+            GCPnts_TangentialDeflection discretizer(adaptor, first, last, m_policy.angular_deflection,
+                m_policy.chordal_deflection, 2, 1.0e-9, std::max(m_policy.min_segment_length, 1.0e-7));
+            contour.points.reserve(discretizer.NbPoints());
+            for (int i = 1; i <= discretizer.NbPoints(); ++i) {
+                contour.points.push_back(ToPoint2D(discretizer.Value(i)));
+            }
+        }
+        else {
+            GCPnts_UniformDeflection discretizer;
+            discretizer.Initialize(adaptor, m_policy.chordal_deflection, first, last);
+            if (!discretizer.IsDone()) {
+                return;
+            }
+            contour.points.reserve(discretizer.NbPoints());
+            for (int i = 1; i <= discretizer.NbPoints(); ++i) {
+                contour.points.push_back(ToPoint2D(discretizer.Value(i)));
+            }
+        }
+        AppendPolyline(std::move(contour), layer);
+    }
+
+    void CurveEmitter::AppendPolyline(geometry_contract::Contour&& contour, geometry_contract::SlicedLayer& layer) const {
+
+        auto& points = contour.points;
+        if (points.empty()) {
+            return;
+        }
+        if (m_policy.snap_resolution <= 0.0 && m_policy.min_segment_length <= 0.0) {
+            // Nothing to enforce: the polyline is kept exactly as sampled, repeated points included.
+            layer.contours.push_back(std::move(contour));
+            return;
+        }
+
+        if (m_policy.snap_resolution > 0.0) {
+            const double resolution = m_policy.snap_resolution;
+            for (auto& p : points) {
+                p.x = std::round(p.x / resolution) * resolution;
+                p.y = std::round(p.y / resolution) * resolution;
+            }
+        }
+
+        // Drop points too close to the last kept one, but always keep the true end point so
+        // neighbouring edges still meet; it replaces the last kept point if that one is too close.
+        const double min_length_sq = m_policy.min_segment_length * m_policy.min_segment_length;
+        size_t kept = 1;
+        for (size_t i = 1; i < points.size(); ++i) {
+            const double dx = points[i].x - points[kept - 1].x;
+            const double dy = points[i].y - points[kept - 1].y;
+            const double length_sq = dx * dx + dy * dy;
+            const bool is_last = i + 1 == points.size();
+            if (length_sq > min_length_sq && length_sq > 0.0) {
+                points[kept++] = points[i];
+            }
+            else if (is_last && kept > 1) {
+                points[kept - 1] = points[i];
+            }
+            else if (is_last && length_sq > 0.0) {
+                points[kept++] = points[i]; // An edge shorter than the minimum still has to connect.
+            }
+        }
+        points.resize(kept);
+
+        if (points.size() >= 2) {
+            layer.contours.push_back(std::move(contour));
+        }
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include "GeometryContract.h"
+
+#include <TopoDS_Edge.hxx>
+#include <Geom_Curve.hxx>
+
+namespace geometry {
+
+    enum class CurveEmission {
+        Polyline, // Every edge is discretized into a polyline.
+        Analytic  // Lines, circles and ellipses keep their exact form, see CurveEmitter.
+    };
+
+    /**
+     * @brief Accuracy targets for turning curves into polylines.
+     *
+     * Point counts follow the accuracy a job actually needs: a fine chordal deflection
+     * for small features, an angular limit so large radii are not over-sampled, and a
+     * snap to the machine resolution so no point carries precision the scanner cannot use.
+     */
+    struct DiscretizationPolicy {
+        // Maximum distance between the curve and its chords, in mm.
+        double chordal_deflection = 0.1;
+        // Maximum turning angle between two consecutive segments, in radians. 0 disables
+        // the angular criterion and samples with GCPnts_UniformDeflection only.
+        double angular_deflection = 0.0;
+        // Points closer than this to the previously kept point are dropped, in mm.
+        double min_segment_length = 0.0;
+        // Grid the polyline points are snapped to, in mm. 0 disables snapping.
+        double snap_resolution = 0.0;
+    };
+
+    /**
+     * @brief Turns the edges of a planar section into layer geometry.
+     *
+     * In CurveEmission::Analytic mode the emitter looks at the underlying curve type:
+     * lines become two-point polylines, circles and ellipses become arcs in the layer's
+     * arcs / ellipses lists, and only the remaining curves (B-splines, offsets, ...) are
+     * discretized. In CurveEmission::Polyline mode everything is discretized.
+     * Polyline points, including line end points, follow the DiscretizationPolicy.
+     */
+    class CurveEmitter {
+    public:
+        CurveEmitter(CurveEmission mode, const DiscretizationPolicy& policy);
+
+        // Appends the edge to the layer. Edges without a 3D curve are skipped.
+        void Emit(const TopoDS_Edge& edge, geometry_contract::SlicedLayer& layer) const;
+
+        // Appends the curve between the two parameters. The curve must lie in a horizontal plane.
+        void EmitCurve(const Handle(Geom_Curve)& curve, double first, double last,
+                       geometry_contract::SlicedLayer& layer) const;
+
+        // Applies snapping and the minimum segment length, then appends the polyline to the layer.
+        // With both disabled the polyline is appended unchanged; otherwise repeated points are
+        // dropped too, and a polyline left with a single point is not appended.
+        void AppendPolyline(geometry_contract::Contour&& contour, geometry_contract::SlicedLayer& layer) const;
+
+    private:
+
+        CurveEmission m_mode;
+        DiscretizationPolicy m_policy;
+    };
+}
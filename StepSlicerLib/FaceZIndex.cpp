@@ -0,0 +1,133 @@
+#include "FaceZIndex.h"
+
+#include <algorithm>
+
+// --- OCCT Includes ---
+#include <BRep_Builder.hxx>
+#include <BRepBndLib.hxx>
+#include <Bnd_Box.hxx>
+#include <TopExp.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Compound.hxx>
+
+namespace geometry {
+
+    // Intervals containing the node's center, plus the subtrees strictly below and above it.
+    struct FaceZIndex::Node {
+        double center;
+        std::vector<Interval> by_min; // Ascending z_min.
+        std::vector<Interval> by_max; // Descending z_max.
+        std::unique_ptr<Node> below;
+        std::unique_ptr<Node> above;
+    };
+
+    FaceZIndex::FaceZIndex(const TopoDS_Shape& shape) {
+
+        // A map visits every face once, even when the shape shares faces between solids.
+        TopTools_IndexedMapOfShape faces;
+        TopExp::MapShapes(shape, TopAbs_FACE, faces);
+
+        std::vector<Interval> intervals;
+        intervals.reserve(faces.Extent());
+        for (int i = 1; i <= faces.Extent(); ++i) {
+            const TopoDS_Face& face = TopoDS::Face(faces(i));
+            Bnd_Box box;
+            // Exact geometry only: a coarse triangulation could shrink the interval below the true face.
+            BRepBndLib::Add(face, box, Standard_False);
+            if (box.IsVoid()) {
+                continue;
+            }
+            Standard_Real x_min, y_min, z_min, x_max, y_max, z_max;
+            box.Get(x_min, y_min, z_min, x_max, y_max, z_max);
+            intervals.push_back({ z_min, z_max, m_faces.size() });
+            m_faces.push_back(face);
+        }
+
+        m_root = Build(intervals);
+    }
+
+    FaceZIndex::~FaceZIndex() = default;
+
+    std::unique_ptr<FaceZIndex::Node> FaceZIndex::Build(std::vector<Interval>& intervals) {
+
+        if (intervals.empty()) {
+            return nullptr;
+        }
+
+        // The median of the interval midpoints splits the rest roughly in half.
+        std::vector<double> midpoints;
+        midpoints.reserve(intervals.size());
+        for (const auto& interval : intervals) {
+            midpoints.push_back(0.5 * (interval.z_min + interval.z_max));
+        }
+        std::nth_element(midpoints.begin(), midpoints.begin() + midpoints.size() / 2, midpoints.end());
+
+        std::unique_ptr<Node> node(new Node);
+        node->center = midpoints[midpoints.size() / 2];
+
+        std::vector<Interval> below, above;
+        for (const auto& interval : intervals) {
+            if (interval.z_max < node->center) {
+                below.push_back(interval);
+            }
+            else if (interval.z_min > node->center) {
+                above.push_back(interval);
+            }
+            else {
+                node->by_min.push_back(interval);
+            }
+        }
+
+        node->by_max = node->by_min;
+        std::sort(node->by_min.begin(), node->by_min.end(),
+            [](const Interval& a, const Interval& b) { return a.z_min < b.z_min; });
+        std::sort(node->by_max.begin(), node->by_max.end(),
+            [](const Interval& a, const Interval& b) { return a.z_max > b.z_max; });
+
+        node->below = Build(below);
+        node->above = Build(above);
+        return node;
+    }
+
+    void FaceZIndex::Query(double z, std::vector<size_t>& face_indices) const {
+
+        face_indices.clear();
+        const Node* node = m_root.get();
+        while (node) {
+            if (z < node->center) {
+                for (const auto& interval : node->by_min) {
+                    if (interval.z_min > z) break;
+                    face_indices.push_back(interval.face);
+                }
+                node = node->below.get();
+            }
+            else {
+                for (const auto& interval : node->by_max) {
+                    if (interval.z_max < z) break;
+                    face_indices.push_back(interval.face);
+                }
+                node = node->above.get();
+            }
+        }
+        // A stable order keeps the section input, and so its output, independent of the tree layout.
+        std::sort(face_indices.begin(), face_indices.end());
+    }
+
+    TopoDS_Shape FaceZIndex::FacesAt(double z) const {
+
+        std::vector<size_t> face_indices;
+        Query(z, face_indices);
+        if (face_indices.empty()) {
+            return TopoDS_Shape();
+        }
+
+        BRep_Builder builder;
+        TopoDS_Compound compound;
+        builder.MakeCompound(compound);
+        for (size_t index : face_indices) {
+            builder.Add(compound, m_faces[index]);
+        }
+        return compound;
+    }
+}
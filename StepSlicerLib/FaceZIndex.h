@@ -0,0 +1,48 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include <TopoDS_Shape.hxx>
+#include <TopoDS_Face.hxx>
+
+namespace geometry {
+
+    /**
+     * @brief Finds the faces of a shape whose Z range spans a given height.
+     *
+     * Each face's Z interval comes from its Bnd_Box, computed once at construction.
+     * The intervals are kept in a centered interval tree, so a query costs
+     * O(log faces + faces crossing the height). The index is read-only after
+     * construction and may be queried from several threads at once.
+     */
+    class FaceZIndex {
+    public:
+        explicit FaceZIndex(const TopoDS_Shape& shape);
+        ~FaceZIndex();
+
+        size_t FaceCount() const { return m_faces.size(); }
+        const TopoDS_Face& Face(size_t index) const { return m_faces[index]; }
+
+        // Indices of the faces whose Z interval contains z, in ascending order.
+        void Query(double z, std::vector<size_t>& face_indices) const;
+
+        /**
+         * @brief Builds a compound of the faces crossing z.
+         * @return A null shape if no face crosses the height.
+         */
+        TopoDS_Shape FacesAt(double z) const;
+
+    private:
+        struct Interval {
+            double z_min;
+            double z_max;
+            size_t face;
+        };
+        struct Node;
+
+        static std::unique_ptr<Node> Build(std::vector<Interval>& intervals);
+
+        std::vector<TopoDS_Face> m_faces;
+        std::unique_ptr<Node> m_root;
+    };
+}
@@ -0,0 +1,419 @@
+#include "MarchingSlicer.h"
+
+#include <algorithm>
+#include <cmath>
+
+// --- OCCT Includes ---
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <BRepAlgoAPI_Section.hxx>
+#include <BRepBndLib.hxx>
+#include <BRepTools.hxx>
+#include <Bnd_Box.hxx>
+#include <GeomAdaptor_Curve.hxx>
+#include <Precision.hxx>
+#include <ShapeAnalysis_Curve.hxx>
+#include <ShapeAnalysis_Surface.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopoDS_Edge.hxx>
+#include <TopoDS_Vertex.hxx>
+#include <gp_Pln.hxx>
+#include <gp_Pnt.hxx>
+#include <gp_Vec.hxx>
+
+namespace geometry {
+
+    namespace {
+        // A point is on the plane once its Z is this close.
+        const double kHeightTolerance = Precision::Confusion();
+        const int kNewtonIterations = 12;
+        // Section points farther than this from the face or its edges are not tracked.
+        const double kFitTolerance = 1.0e-4;
+        // Samples per parameter direction when looking for critical points of Z.
+        const int kSurfaceSamples = 32;
+        const int kEdgeSamples = 32;
+
+        double Distance(const geometry_contract::Point2D& a, const geometry_contract::Point2D& b) {
+            return std::hypot(a.x - b.x, a.y - b.y);
+        }
+
+        geometry_contract::Point2D ToPoint2D(const gp_Pnt& p) {
+            return { p.X(), p.Y() };
+        }
+
+        // Whether the samples straddle zero, so the function may vanish between them.
+        bool StraddlesZero(double a, double b, double c, double d) {
+            return std::min(std::min(a, b), std::min(c, d)) <= 0.0 && std::max(std::max(a, b), std::max(c, d)) >= 0.0;
+        }
+
+        void AddBand(std::vector<std::pair<double, double>>& bands, double z_a, double z_b) {
+            bands.emplace_back(std::min(z_a, z_b), std::max(z_a, z_b));
+        }
+
+        // Newton on C(t).z = z, keeping t on the edge.
+        bool MarchOnCurve(const Handle(Geom_Curve)& curve, double first, double last, double& t, double z, gp_Pnt& point) {
+            gp_Vec tangent;
+            for (int i = 0; i < kNewtonIterations; ++i) {
+                curve->D1(t, point, tangent);
+                const double dz = z - point.Z();
+                if (std::abs(dz) <= kHeightTolerance) {
+                    return true;
+                }
+                if (std::abs(tangent.Z()) < Precision::Confusion()) {
+                    return false; // The edge runs level here; the crossing may have vanished.
+                }
+                t += dz / tangent.Z();
+                if (t < first - Precision::PConfusion() || t > last + Precision::PConfusion()) {
+                    return false;
+                }
+            }
+            return false;
+        }
+
+        // Newton on S(u, v).z = z with the smallest UV step, i.e. along the Z gradient in UV.
+        bool MarchOnSurface(const Handle(Geom_Surface)& surface, double u_min, double u_max, double v_min, double v_max,
+                            gp_Pnt2d& uv, double z, gp_Pnt& point) {
+            gp_Vec d_u, d_v;
+            double u = uv.X();
+            double v = uv.Y();
+            for (int i = 0; i < kNewtonIterations; ++i) {
+                surface->D1(u, v, point, d_u, d_v);
+                const double dz = z - point.Z();
+                if (std::abs(dz) <= kHeightTolerance) {
+                    uv.SetCoord(u, v);
+                    return true;
+                }
+                const double gradient_sq = d_u.Z() * d_u.Z() + d_v.Z() * d_v.Z();
+                if (gradient_sq < Precision::SquareConfusion()) {
+                    return false; // Near a critical point of Z the curve changes shape.
+                }
+                u += dz * d_u.Z() / gradient_sq;
+                v += dz * d_v.Z() / gradient_sq;
+                if (u < u_min - Precision::PConfusion() || u > u_max + Precision::PConfusion()
+                    || v < v_min - Precision::PConfusion() || v > v_max + Precision::PConfusion()) {
+                    return false;
+                }
+            }
+            return false;
+        }
+
+        // The tight Z range of the exact geometry.
+        bool ZRange(const TopoDS_Shape& shape, double& z_min, double& z_max) {
+            Bnd_Box box;
+            BRepBndLib::AddOptimal(shape, box, Standard_False, Standard_False);
+            if (box.IsVoid()) {
+                return false;
+            }
+            Standard_Real x_min, y_min, x_max, y_max;
+            box.Get(x_min, y_min, z_min, x_max, y_max, z_max);
+            return true;
+        }
+    }
+
+    MarchingSlicer::MarchingSlicer(const FaceZIndex& face_index, CurveEmission mode, const DiscretizationPolicy& policy,
+                                   bool analytic_faces)
+        : m_face_index(face_index),
+        m_emitter(CurveEmission::Polyline, policy),
+        m_analytic_emitter(mode, policy),
+        m_seed_emitter(CurveEmission::Polyline, [&policy] {
+            DiscretizationPolicy seed_policy = policy;
+            seed_policy.snap_resolution = 0.0;
+            seed_policy.min_segment_length = 0.0;
+            return seed_policy;
+        }()),
+        m_sectioner(m_analytic_emitter),
+        m_analytic_faces(analytic_faces),
+        m_chordal_deflection(policy.chordal_deflection),
+        m_info(face_index.FaceCount()) {
+    }
+
+    geometry_contract::SlicedLayer MarchingSlicer::SliceAt(double z) {
+
+        geometry_contract::SlicedLayer layer;
+        layer.ZHeight = z;
+
+        m_face_indices.clear();
+        m_face_index.Query(z, m_face_indices);
+
+        // Faces that no longer cross the plane drop their state.
+        std::unordered_map<size_t, FaceState> states;
+        m_seed_faces.clear();
+        for (size_t index : m_face_indices) {
+            const TopoDS_Face& face = m_face_index.Face(index);
+            if (m_analytic_faces && m_sectioner.Section(face, z, layer)) {
+                continue;
+            }
+
+            const FaceInfo& info = Info(index);
+            FaceState state;
+            auto previous = m_states.find(index);
+            if (previous != m_states.end()) {
+                state = std::move(previous->second);
+            }
+
+            if (state.trackable && !CrossesCritical(info, state.z, z) && March(info, state, z, layer)) {
+                ++m_marched_sections;
+            }
+            else {
+                m_seed_faces.push_back(index);
+            }
+            state.z = z;
+            states.emplace(index, std::move(state));
+        }
+        if (!m_seed_faces.empty()) {
+            Seed(z, states, layer);
+            m_full_sections += m_seed_faces.size();
+        }
+        m_states.swap(states);
+
+        return layer;
+    }
+
+    MarchingSlicer::FaceInfo& MarchingSlicer::Info(size_t face) {
+        FaceInfo& info = m_info[face];
+        if (!info.analyzed) {
+            AnalyzeFace(m_face_index.Face(face), info);
+            info.analyzed = true;
+        }
+        return info;
+    }
+
+    void MarchingSlicer::AnalyzeFace(const TopoDS_Face& face, FaceInfo& info) {
+
+        info.surface = BRep_Tool::Surface(face);
+        BRepTools::UVBounds(face, info.u_min, info.u_max, info.v_min, info.v_max);
+        auto& bands = info.critical;
+
+        double z_min, z_max;
+        if (ZRange(face, z_min, z_max)) {
+            AddBand(bands, z_min, z_min);
+            AddBand(bands, z_max, z_max);
+        }
+        for (TopExp_Explorer explorer(face, TopAbs_VERTEX); explorer.More(); explorer.Next()) {
+            const double z = BRep_Tool::Pnt(TopoDS::Vertex(explorer.Current())).Z();
+            AddBand(bands, z, z);
+        }
+
+        // A section end point appears or vanishes where a boundary edge turns in Z. Wherever
+        // the edge's slope changes sign between two samples, the band between them is critical.
+        for (TopExp_Explorer explorer(face, TopAbs_EDGE); explorer.More(); explorer.Next()) {
+            const TopoDS_Edge& edge = TopoDS::Edge(explorer.Current());
+            Standard_Real first, last;
+            Handle(Geom_Curve) curve = BRep_Tool::Curve(edge, first, last);
+            if (curve.IsNull() || BRep_Tool::Degenerated(edge)) {
+                continue;
+            }
+            gp_Pnt point;
+            gp_Vec tangent;
+            double previous_z = 0.0, previous_slope = 0.0;
+            for (int i = 0; i <= kEdgeSamples; ++i) {
+                curve->D1(first + (last - first) * i / kEdgeSamples, point, tangent);
+                if (i > 0 && previous_slope * tangent.Z() <= 0.0) {
+                    AddBand(bands, previous_z, point.Z());
+                }
+                previous_z = point.Z();
+                previous_slope = tangent.Z();
+            }
+        }
+
+        // A closed section loop appears or vanishes at a critical point of Z inside the face,
+        // where both UV components of the Z gradient vanish.
+        const int n = kSurfaceSamples;
+        std::vector<double> z(static_cast<size_t>((n + 1) * (n + 1)));
+        std::vector<double> dz_du(z.size()), dz_dv(z.size());
+        gp_Pnt point;
+        gp_Vec d_u, d_v;
+        for (int i = 0; i <= n; ++i) {
+            for (int j = 0; j <= n; ++j) {
+                const double u = info.u_min + (info.u_max - info.u_min) * i / n;
+                const double v = info.v_min + (info.v_max - info.v_min) * j / n;
+                info.surface->D1(u, v, point, d_u, d_v);
+                const size_t k = static_cast<size_t>(i * (n + 1) + j);
+                z[k] = point.Z();
+                dz_du[k] = d_u.Z();
+                dz_dv[k] = d_v.Z();
+            }
+        }
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                const size_t c[4] = { static_cast<size_t>(i * (n + 1) + j), static_cast<size_t>(i * (n + 1) + j + 1),
+                                      static_cast<size_t>((i + 1) * (n + 1) + j), static_cast<size_t>((i + 1) * (n + 1) + j + 1) };
+                if (StraddlesZero(dz_du[c[0]], dz_du[c[1]], dz_du[c[2]], dz_du[c[3]])
+                    && StraddlesZero(dz_dv[c[0]], dz_dv[c[1]], dz_dv[c[2]], dz_dv[c[3]])) {
+                    AddBand(bands, std::min(std::min(z[c[0]], z[c[1]]), std::min(z[c[2]], z[c[3]])),
+                                   std::max(std::max(z[c[0]], z[c[1]]), std::max(z[c[2]], z[c[3]])));
+                }
+            }
+        }
+    }
+
+    bool MarchingSlicer::CrossesCritical(const FaceInfo& info, double z_from, double z_to) {
+        const double low = std::min(z_from, z_to) - kHeightTolerance;
+        const double high = std::max(z_from, z_to) + kHeightTolerance;
+        for (const auto& band : info.critical) {
+            if (band.second >= low && band.first <= high) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void MarchingSlicer::Seed(double z, std::unordered_map<size_t, FaceState>& states,
+                              geometry_contract::SlicedLayer& layer) const {
+
+        // One boolean for all the faces, so an edge two of them share is sectioned once
+        // instead of once per face.
+        TopTools_IndexedMapOfShape faces;
+        TopoDS_Compound compound;
+        BRep_Builder builder;
+        builder.MakeCompound(compound);
+        for (size_t index : m_seed_faces) {
+            const TopoDS_Face& face = m_face_index.Face(index);
+            faces.Add(face);
+            builder.Add(compound, face);
+        }
+
+        gp_Pln slicing_plane(gp_Pnt(0, 0, z), gp_Dir(0, 0, 1));
+        BRepAlgoAPI_Section section(compound, slicing_plane, Standard_False);
+        // The model is shared between threads, so the boolean must not touch its tolerances.
+        section.SetNonDestructive(Standard_True);
+        section.Build();
+
+        // Each face is tracked from the section edges lying on it. An edge on a boundary of
+        // the faces has no single ancestor, but then the plane passes through a vertex, a
+        // critical height at which the faces are sectioned again on the next layer anyway.
+        std::vector<geometry_contract::SlicedLayer> seeds(m_seed_faces.size());
+        for (TopExp_Explorer explorer(section.Shape(), TopAbs_EDGE); explorer.More(); explorer.Next()) {
+            const TopoDS_Edge& edge = TopoDS::Edge(explorer.Current());
+            m_emitter.Emit(edge, layer);
+            TopoDS_Shape ancestor;
+            if (section.HasAncestorFaceOn1(edge, ancestor)) {
+                const int position = faces.FindIndex(ancestor);
+                if (position > 0) {
+                    m_seed_emitter.Emit(edge, seeds[static_cast<size_t>(position - 1)]);
+                }
+            }
+        }
+
+        for (size_t i = 0; i < m_seed_faces.size(); ++i) {
+            const size_t index = m_seed_faces[i];
+            FaceState& state = states[index];
+            state.tracks.clear();
+            state.trackable = section.IsDone();
+            for (const auto& contour : seeds[i].contours) {
+                Track track;
+                if (!state.trackable || !MakeTrack(m_face_index.Face(index), m_info[index], contour, z, track)) {
+                    state.trackable = false;
+                    state.tracks.clear();
+                    break;
+                }
+                state.tracks.push_back(std::move(track));
+            }
+        }
+    }
+
+    bool MarchingSlicer::MakeTrack(const TopoDS_Face& face, const FaceInfo& info, const geometry_contract::Contour& contour,
+                                   double z, Track& track) const {
+
+        const auto& points = contour.points;
+        if (points.size() < 2) {
+            return false;
+        }
+        track.closed = points.size() >= 3 && Distance(points.front(), points.back()) < kFitTolerance;
+
+        // Open curves end on the face boundary; their end points follow the boundary edge.
+        if (!track.closed) {
+            Anchor* anchors[2] = { &track.start, &track.end };
+            const gp_Pnt ends[2] = { gp_Pnt(points.front().x, points.front().y, z), gp_Pnt(points.back().x, points.back().y, z) };
+            const ShapeAnalysis_Curve projector;
+            for (int a = 0; a < 2; ++a) {
+                double best = kFitTolerance;
+                bool found = false;
+                for (TopExp_Explorer explorer(face, TopAbs_EDGE); explorer.More(); explorer.Next()) {
+                    Standard_Real first, last;
+                    Handle(Geom_Curve) curve = BRep_Tool::Curve(TopoDS::Edge(explorer.Current()), first, last);
+                    if (curve.IsNull()) {
+                        continue;
+                    }
+                    gp_Pnt projection;
+                    Standard_Real parameter;
+                    const double distance = projector.Project(GeomAdaptor_Curve(curve, first, last), ends[a],
+                                                              kFitTolerance, projection, parameter, Standard_False);
+                    if (distance <= best) {
+                        best = distance;
+                        *anchors[a] = { curve, first, last, parameter };
+                        found = true;
+                    }
+                }
+                if (!found) {
+                    return false;
+                }
+            }
+        }
+
+        Handle(ShapeAnalysis_Surface) analysis = new ShapeAnalysis_Surface(info.surface);
+        const size_t begin = track.closed ? 0 : 1;
+        const size_t end = track.closed ? points.size() : points.size() - 1;
+        track.uv.reserve(end - begin);
+        for (size_t i = begin; i < end; ++i) {
+            const gp_Pnt point(points[i].x, points[i].y, z);
+            const gp_Pnt2d uv = track.uv.empty() ? analysis->ValueOfUV(point, kFitTolerance)
+                                                 : analysis->NextValueOfUV(track.uv.back(), point, kFitTolerance);
+            if (analysis->Gap() > kFitTolerance) {
+                return false;
+            }
+            track.uv.push_back(uv);
+        }
+
+        track.seed_lengths.resize(points.size() - 1);
+        for (size_t i = 0; i + 1 < points.size(); ++i) {
+            track.seed_lengths[i] = Distance(points[i], points[i + 1]);
+        }
+        return true;
+    }
+
+    bool MarchingSlicer::March(const FaceInfo& info, FaceState& state, double z, geometry_contract::SlicedLayer& layer) const {
+
+        std::vector<geometry_contract::Contour> contours;
+        contours.reserve(state.tracks.size());
+        gp_Pnt point;
+        for (auto& track : state.tracks) {
+            geometry_contract::Contour contour;
+            contour.points.reserve(track.seed_lengths.size() + 1);
+            if (!track.closed) {
+                if (!MarchOnCurve(track.start.curve, track.start.first, track.start.last, track.start.parameter, z, point)) {
+                    return false;
+                }
+                contour.points.push_back(ToPoint2D(point));
+            }
+            for (auto& uv : track.uv) {
+                if (!MarchOnSurface(info.surface, info.u_min, info.u_max, info.v_min, info.v_max, uv, z, point)) {
+                    return false;
+                }
+                contour.points.push_back(ToPoint2D(point));
+            }
+            if (!track.closed) {
+                if (!MarchOnCurve(track.end.curve, track.end.first, track.end.last, track.end.parameter, z, point)) {
+                    return false;
+                }
+                contour.points.push_back(ToPoint2D(point));
+            }
+
+            // A stretched segment no longer meets the chordal deflection; section the face again.
+            for (size_t i = 0; i + 1 < contour.points.size(); ++i) {
+                if (Distance(contour.points[i], contour.points[i + 1]) > 2.0 * track.seed_lengths[i] + m_chordal_deflection) {
+                    return false;
+                }
+            }
+            contours.push_back(std::move(contour));
+        }
+
+        for (auto& contour : contours) {
+            m_emitter.AppendPolyline(std::move(contour), layer);
+        }
+        return true;
+    }
+}
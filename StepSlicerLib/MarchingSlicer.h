@@ -0,0 +1,123 @@
+#pragma once
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "GeometryContract.h"
+#include "AnalyticSectioner.h"
+#include "CurveEmitter.h"
+#include "FaceZIndex.h"
+
+#include <Geom_Curve.hxx>
+#include <Geom_Surface.hxx>
+#include <gp_Pnt2d.hxx>
+
+namespace geometry {
+
+    /**
+     * @brief Sections a shape layer after layer, carrying each face's section curves upwards.
+     *
+     * Faces the AnalyticSectioner handles are sectioned in closed form as usual. Every other
+     * face crossing a layer is sectioned with a boolean once, shared by all faces of the
+     * layer that need one, and its curves are kept as polylines: the end points as
+     * parameters on the face's boundary edges, the rest as UV points on the surface. For
+     * the next layer every point is moved onto the new plane with a few Newton steps, the
+     * end points along their edge and the others along the surface's Z gradient, so a face
+     * costs a handful of surface evaluations per point instead of a boolean.
+     *
+     * A face is sectioned again whenever its topology may have changed: when the step
+     * between two layers passes a critical height of the face (a vertex, a Z extremum of a
+     * boundary edge or a critical point of Z inside the face), when a Newton step fails or
+     * leaves the face's parameter range, or when a segment has stretched to more than twice
+     * its length. Critical points inside faces and edges are found on a sampling grid, so
+     * Z features much smaller than a grid cell may go unnoticed until the next re-section.
+     *
+     * The slicer keeps state between calls and is not thread-safe.
+     */
+    class MarchingSlicer {
+    public:
+        /**
+         * @param face_index     Faces of the shape to slice. Must outlive the slicer.
+         * @param mode           How the faces sectioned in closed form become layer geometry.
+         *                       Tracked faces always become polylines, since marching carries
+         *                       points; emitting them otherwise only on the layers where they
+         *                       are sectioned would change a face's geometry from layer to layer.
+         * @param policy         Accuracy of the polylines.
+         * @param analytic_faces Section analytic faces in closed form instead of tracking them.
+         */
+        MarchingSlicer(const FaceZIndex& face_index, CurveEmission mode, const DiscretizationPolicy& policy,
+                       bool analytic_faces = true);
+
+        /**
+         * @brief Sections the shape at a height.
+         *
+         * Heights may come in any order, but only consecutive nearby heights can reuse the
+         * curves of the previous call. The contours are not assembled.
+         */
+        geometry_contract::SlicedLayer SliceAt(double z);
+
+        // Face sections computed with a boolean and face sections carried from the layer before.
+        size_t FullSectionCount() const { return m_full_sections; }
+        size_t MarchedSectionCount() const { return m_marched_sections; }
+
+    private:
+        // A section end point on a boundary edge of the face.
+        struct Anchor {
+            Handle(Geom_Curve) curve;
+            double first;
+            double last;
+            double parameter;
+        };
+
+        // One section polyline of a face.
+        struct Track {
+            bool closed = false;
+            Anchor start;            // Unused for closed tracks.
+            Anchor end;
+            std::vector<gp_Pnt2d> uv; // The points between the anchors, or every point of a closed track.
+            std::vector<double> seed_lengths; // Segment lengths right after sectioning.
+        };
+
+        // The tracks of a face at the height of the last layer that crossed it.
+        struct FaceState {
+            bool trackable = false;
+            double z = 0.0;
+            std::vector<Track> tracks;
+        };
+
+        // Per-face data that does not depend on the height, computed when first needed.
+        struct FaceInfo {
+            bool analyzed = false;
+            Handle(Geom_Surface) surface;
+            double u_min, u_max, v_min, v_max;
+            std::vector<std::pair<double, double>> critical; // Z bands where the topology may change.
+        };
+
+        FaceInfo& Info(size_t face);
+        static void AnalyzeFace(const TopoDS_Face& face, FaceInfo& info);
+        static bool CrossesCritical(const FaceInfo& info, double z_from, double z_to);
+
+        // Sections the faces of m_seed_faces with one boolean, appends them to the layer and
+        // rebuilds their states.
+        void Seed(double z, std::unordered_map<size_t, FaceState>& states, geometry_contract::SlicedLayer& layer) const;
+        bool MakeTrack(const TopoDS_Face& face, const FaceInfo& info, const geometry_contract::Contour& contour,
+                       double z, Track& track) const;
+        // Moves the state to z and appends its polylines. Appends nothing if it fails.
+        bool March(const FaceInfo& info, FaceState& state, double z, geometry_contract::SlicedLayer& layer) const;
+
+        const FaceZIndex& m_face_index;
+        CurveEmitter m_emitter;          // Polylines of the tracked faces, sectioned or marched.
+        CurveEmitter m_analytic_emitter; // The faces of m_sectioner, in the requested mode.
+        CurveEmitter m_seed_emitter; // Unsnapped polylines, so the tracked points lie on the surface.
+        AnalyticSectioner m_sectioner;
+        bool m_analytic_faces;
+        double m_chordal_deflection;
+
+        std::vector<FaceInfo> m_info;
+        std::unordered_map<size_t, FaceState> m_states; // By face index, for the faces of the last layer.
+        std::vector<size_t> m_face_indices;
+        std::vector<size_t> m_seed_faces; // Faces of the current layer that need a boolean.
+        size_t m_full_sections = 0;
+        size_t m_marched_sections = 0;
+    };
+}
@@ -0,0 +1,236 @@
+#include "MeshSlicer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+// --- OCCT Includes ---
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <BRep_Tool.hxx>
+#include <Poly_Triangulation.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopLoc_Location.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Face.hxx>
+#include <gp_Trsf.hxx>
+
+namespace geometry {
+
+    namespace {
+        // Nodes closer than this are welded; faces share their boundary nodes only up to rounding.
+        const double kWeldResolution = 1e-6;
+
+        struct GridKey {
+            int64_t x, y, z;
+            bool operator==(const GridKey& other) const {
+                return x == other.x && y == other.y && z == other.z;
+            }
+        };
+
+        struct GridKeyHash {
+            size_t operator()(const GridKey& key) const {
+                uint64_t h = static_cast<uint64_t>(key.x) * 0x9E3779B97F4A7C15ULL;
+                h ^= static_cast<uint64_t>(key.y) * 0xC2B2AE3D27D4EB4FULL + (h << 6) + (h >> 2);
+                h ^= static_cast<uint64_t>(key.z) * 0x165667B19E3779F9ULL + (h << 6) + (h >> 2);
+                return static_cast<size_t>(h);
+            }
+        };
+
+        // An undirected mesh edge, identified by its two welded node indices.
+        uint64_t EdgeKey(uint32_t a, uint32_t b) {
+            if (a > b) std::swap(a, b);
+            return (static_cast<uint64_t>(a) << 32) | b;
+        }
+    }
+
+    MeshSlicer::MeshSlicer(const TopoDS_Shape& shape, double deflection, bool parallel)
+        : m_deflection(deflection) {
+        BuildMesh(shape, parallel);
+    }
+
+    void MeshSlicer::BuildMesh(const TopoDS_Shape& shape, bool parallel) {
+
+        BRepMesh_IncrementalMesh mesher(shape, m_deflection, Standard_False, 0.5, parallel);
+
+        std::unordered_map<GridKey, uint32_t, GridKeyHash> welded;
+        std::vector<uint32_t> face_nodes;
+
+        for (TopExp_Explorer explorer(shape, TopAbs_FACE); explorer.More(); explorer.Next()) {
+            const TopoDS_Face& face = TopoDS::Face(explorer.Current());
+            TopLoc_Location location;
+            Handle(Poly_Triangulation) triangulation = BRep_Tool::Triangulation(face, location);
+            if (triangulation.IsNull()) {
+                continue;
+            }
+            const gp_Trsf& transformation = location.Transformation();
+
+            face_nodes.assign(triangulation->NbNodes(), 0);
+            for (int i = 1; i <= triangulation->NbNodes(); ++i) {
+                gp_Pnt node = triangulation->Node(i).Transformed(transformation);
+                GridKey key = {
+                    static_cast<int64_t>(std::llround(node.X() / kWeldResolution)),
+                    static_cast<int64_t>(std::llround(node.Y() / kWeldResolution)),
+                    static_cast<int64_t>(std::llround(node.Z() / kWeldResolution))
+                };
+                auto inserted = welded.emplace(key, static_cast<uint32_t>(m_nodes.size() / 3));
+                if (inserted.second) {
+                    m_nodes.push_back(node.X());
+                    m_nodes.push_back(node.Y());
+                    m_nodes.push_back(node.Z());
+                }
+                face_nodes[i - 1] = inserted.first->second;
+            }
+
+            for (int i = 1; i <= triangulation->NbTriangles(); ++i) {
+                int n1, n2, n3;
+                triangulation->Triangle(i).Get(n1, n2, n3);
+                Triangle triangle;
+                triangle.nodes[0] = face_nodes[n1 - 1];
+                triangle.nodes[1] = face_nodes[n2 - 1];
+                triangle.nodes[2] = face_nodes[n3 - 1];
+                // Triangles collapsed by the weld cannot cross a plane in a meaningful way.
+                if (triangle.nodes[0] == triangle.nodes[1] || triangle.nodes[1] == triangle.nodes[2] ||
+                    triangle.nodes[0] == triangle.nodes[2]) {
+                    continue;
+                }
+                triangle.z_min = triangle.z_max = m_nodes[triangle.nodes[0] * 3 + 2];
+                for (int k = 1; k < 3; ++k) {
+                    const double z = m_nodes[triangle.nodes[k] * 3 + 2];
+                    triangle.z_min = std::min(triangle.z_min, z);
+                    triangle.z_max = std::max(triangle.z_max, z);
+                }
+                m_triangles.push_back(triangle);
+            }
+        }
+
+        std::sort(m_triangles.begin(), m_triangles.end(),
+            [](const Triangle& a, const Triangle& b) { return a.z_min < b.z_min; });
+    }
+
+    std::vector<geometry_contract::SlicedLayer> MeshSlicer::Slice(const std::vector<double>& heights) const {
+
+        std::vector<geometry_contract::SlicedLayer> layers;
+        layers.reserve(heights.size());
+        Slice(heights, [&layers](geometry_contract::SlicedLayer&& layer) {
+            layers.push_back(std::move(layer));
+            return true;
+        });
+        return layers;
+    }
+
+    bool MeshSlicer::Slice(const std::vector<double>& heights, const geometry_contract::LayerSink& sink) const {
+
+        std::vector<uint32_t> active;      // Indices into m_triangles spanning the current plane.
+        size_t next_triangle = 0;
+
+        // Per-layer scratch: one crossing point per mesh edge, and the segments between them.
+        std::unordered_map<uint64_t, uint32_t> edge_points;
+        std::vector<geometry_contract::Point2D> points;
+        std::vector<uint32_t> segments;    // Pairs of indices into points.
+        std::vector<uint32_t> links;       // Up to two segments per point, UINT32_MAX if unused.
+        std::vector<bool> visited;
+
+        for (const double z : heights) {
+            geometry_contract::SlicedLayer layer;
+            layer.ZHeight = z;
+
+            // Advance the sweep: admit triangles starting below the plane, retire those ending below it.
+            while (next_triangle < m_triangles.size() && m_triangles[next_triangle].z_min < z) {
+                active.push_back(static_cast<uint32_t>(next_triangle++));
+            }
+            active.erase(std::remove_if(active.begin(), active.end(),
+                [&](uint32_t t) { return m_triangles[t].z_max < z; }), active.end());
+
+            edge_points.clear();
+            points.clear();
+            segments.clear();
+
+            // A node on the plane counts as above it, so every crossing triangle has exactly two
+            // crossing edges and neighbouring triangles agree on which edges those are.
+            for (uint32_t t : active) {
+                const Triangle& triangle = m_triangles[t];
+                uint32_t crossing[2];
+                int nb_crossing = 0;
+                for (int k = 0; k < 3; ++k) {
+                    const uint32_t a = triangle.nodes[k];
+                    const uint32_t b = triangle.nodes[(k + 1) % 3];
+                    const double za = m_nodes[a * 3 + 2];
+                    const double zb = m_nodes[b * 3 + 2];
+                    if ((za < z) == (zb < z)) {
+                        continue;
+                    }
+                    auto inserted = edge_points.emplace(EdgeKey(a, b), static_cast<uint32_t>(points.size()));
+                    if (inserted.second) {
+                        // Interpolate from the lower node index so both neighbours compute the same point.
+                        const uint32_t lo = std::min(a, b);
+                        const uint32_t hi = std::max(a, b);
+                        const double t_param = (z - m_nodes[lo * 3 + 2]) / (m_nodes[hi * 3 + 2] - m_nodes[lo * 3 + 2]);
+                        points.push_back({
+                            m_nodes[lo * 3] + t_param * (m_nodes[hi * 3] - m_nodes[lo * 3]),
+                            m_nodes[lo * 3 + 1] + t_param * (m_nodes[hi * 3 + 1] - m_nodes[lo * 3 + 1])
+                        });
+                    }
+                    crossing[nb_crossing++] = inserted.first->second;
+                }
+                if (nb_crossing == 2) {
+                    segments.push_back(crossing[0]);
+                    segments.push_back(crossing[1]);
+                }
+            }
+
+            if (segments.empty()) {
+                continue;
+            }
+
+            // Chain the segments through their shared crossing points.
+            const uint32_t kNone = UINT32_MAX;
+            const size_t nb_segments = segments.size() / 2;
+            links.assign(points.size() * 2, kNone);
+            for (uint32_t s = 0; s < nb_segments; ++s) {
+                for (int end = 0; end < 2; ++end) {
+                    const uint32_t p = segments[s * 2 + end];
+                    links[p * 2 + (links[p * 2] == kNone ? 0 : 1)] = s;
+                }
+            }
+            visited.assign(nb_segments, false);
+
+            auto walk = [&](uint32_t start_segment, uint32_t start_point) {
+                geometry_contract::Contour contour;
+                contour.points.push_back(points[start_point]);
+                uint32_t segment = start_segment;
+                uint32_t point = start_point;
+                while (segment != kNone && !visited[segment]) {
+                    visited[segment] = true;
+                    point = segments[segment * 2] == point ? segments[segment * 2 + 1] : segments[segment * 2];
+                    // Nodes lying on the plane produce zero-length segments; skip the repeated point.
+                    const geometry_contract::Point2D& last = contour.points.back();
+                    if (points[point].x != last.x || points[point].y != last.y) {
+                        contour.points.push_back(points[point]);
+                    }
+                    segment = links[point * 2] == segment ? links[point * 2 + 1] : links[point * 2];
+                }
+                contour.closed = point == start_point && contour.points.size() > 2;
+                layer.contours.push_back(std::move(contour));
+            };
+
+            // Open chains (holes in the mesh) start from their free ends, then the closed loops.
+            for (uint32_t p = 0; p < points.size(); ++p) {
+                const uint32_t s = links[p * 2];
+                if (s != kNone && links[p * 2 + 1] == kNone && !visited[s]) {
+                    walk(s, p);
+                }
+            }
+            for (uint32_t s = 0; s < nb_segments; ++s) {
+                if (!visited[s]) {
+                    walk(s, segments[s * 2]);
+                }
+            }
+
+            if (!sink(std::move(layer))) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
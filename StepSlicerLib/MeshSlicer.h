@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "GeometryContract.h"
+
+#include <TopoDS_Shape.hxx>
+
+namespace geometry {
+
+    /**
+     * @brief Slices a shape through its triangle mesh instead of exact boolean sections.
+     *
+     * The shape is triangulated once with BRepMesh_IncrementalMesh. Triangles are sorted
+     * by their lowest Z, and all layers are produced in a single upward sweep that keeps
+     * only the triangles spanning the current plane active. Each layer then costs
+     * O(active triangles) instead of a full boolean section.
+     *
+     * Coincident mesh nodes are welded, so the segments of a layer are chained through
+     * the mesh edges they cross and closed surfaces produce closed contours.
+     */
+    class MeshSlicer {
+    public:
+        /**
+         * @param shape      The shape to slice. Its faces receive the triangulation.
+         * @param deflection Linear deflection of the mesh, i.e. the maximum chordal
+         *                   error of the resulting contours.
+         * @param parallel   Lets BRepMesh triangulate faces in parallel.
+         */
+        MeshSlicer(const TopoDS_Shape& shape, double deflection, bool parallel = false);
+
+        double Deflection() const { return m_deflection; }
+        size_t TriangleCount() const { return m_triangles.size(); }
+
+        /**
+         * @brief Sections the mesh at each height.
+         * @param heights Slicing heights in ascending order.
+         * @return One layer per height that cuts the mesh, in the same order. Heights
+         *         that miss the mesh produce no layer, as in StepSlicer::Slice.
+         */
+        std::vector<geometry_contract::SlicedLayer> Slice(const std::vector<double>& heights) const;
+
+        /**
+         * @brief Sections the mesh at each height and hands each layer to the sink as soon
+         *        as it is finished, so only one layer is held at a time. Heights that
+         *        miss the mesh are skipped.
+         * @return false if the sink stopped the sweep.
+         */
+        bool Slice(const std::vector<double>& heights, const geometry_contract::LayerSink& sink) const;
+
+    private:
+        struct Triangle {
+            uint32_t nodes[3];
+            double z_min;
+            double z_max;
+        };
+
+        void BuildMesh(const TopoDS_Shape& shape, bool parallel);
+
+        double m_deflection;
+        std::vector<double> m_nodes; // Welded mesh nodes as packed x, y, z.
+        std::vector<Triangle> m_triangles; // Sorted by z_min.
+    };
+}
@@ -0,0 +1,147 @@
+#include "PrismaticRegions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+// --- OCCT Includes ---
+#include <BRep_Tool.hxx>
+#include <BRepAdaptor_Curve.hxx>
+#include <BRepAdaptor_Surface.hxx>
+#include <BRepBndLib.hxx>
+#include <Bnd_Box.hxx>
+#include <Precision.hxx>
+#include <TopExp.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopoDS.hxx>
+#include <gp_Dir.hxx>
+
+namespace geometry {
+
+    namespace {
+        // Directions closer to vertical or horizontal than this are treated as exactly so.
+        const double kAxisTolerance = 1.0e-9;
+
+        bool IsVertical(const gp_Dir& direction) {
+            return std::abs(std::abs(direction.Z()) - 1.0) < kAxisTolerance;
+        }
+
+        bool IsHorizontal(const gp_Dir& direction) {
+            return std::abs(direction.Z()) < kAxisTolerance;
+        }
+
+        // Surfaces swept by a vertical line, whose horizontal sections are all the same curve.
+        bool IsVerticalRuledFace(const TopoDS_Face& face) {
+            BRepAdaptor_Surface surface(face, Standard_False);
+            switch (surface.GetType()) {
+            case GeomAbs_Plane:
+                return IsHorizontal(surface.Plane().Axis().Direction());
+            case GeomAbs_Cylinder:
+                return IsVertical(surface.Cylinder().Axis().Direction());
+            case GeomAbs_SurfaceOfExtrusion:
+                return IsVertical(surface.Direction());
+            default:
+                return false;
+            }
+        }
+
+        bool IsVerticalLine(const TopoDS_Edge& edge) {
+            BRepAdaptor_Curve curve(edge);
+            return curve.GetType() == GeomAbs_Line && IsVertical(curve.Line().Direction());
+        }
+
+        // The tight Z range of the exact geometry, without tolerance enlargement.
+        bool ZRange(const TopoDS_Shape& shape, double& z_min, double& z_max) {
+            Bnd_Box box;
+            BRepBndLib::AddOptimal(shape, box, Standard_False, Standard_False);
+            if (box.IsVoid()) {
+                return false;
+            }
+            Standard_Real x_min, y_min, x_max, y_max;
+            box.Get(x_min, y_min, z_min, x_max, y_max, z_max);
+            return true;
+        }
+    }
+
+    PrismaticRegions::PrismaticRegions(const TopoDS_Shape& shape) {
+
+        std::vector<double> critical;
+        // Z ranges over which some face or edge changes the section.
+        std::vector<std::pair<double, double>> blocked;
+        double z_min, z_max;
+
+        TopTools_IndexedMapOfShape faces;
+        TopExp::MapShapes(shape, TopAbs_FACE, faces);
+        for (int i = 1; i <= faces.Extent(); ++i) {
+            const TopoDS_Face& face = TopoDS::Face(faces(i));
+            if (!IsVerticalRuledFace(face) && ZRange(face, z_min, z_max)) {
+                critical.push_back(z_min);
+                critical.push_back(z_max);
+                blocked.emplace_back(z_min, z_max);
+            }
+        }
+
+        TopTools_IndexedMapOfShape edges;
+        TopExp::MapShapes(shape, TopAbs_EDGE, edges);
+        for (int i = 1; i <= edges.Extent(); ++i) {
+            const TopoDS_Edge& edge = TopoDS::Edge(edges(i));
+            if (!BRep_Tool::Degenerated(edge) && !IsVerticalLine(edge) && ZRange(edge, z_min, z_max)) {
+                critical.push_back(z_min);
+                critical.push_back(z_max);
+                blocked.emplace_back(z_min, z_max);
+            }
+        }
+
+        TopTools_IndexedMapOfShape vertices;
+        TopExp::MapShapes(shape, TopAbs_VERTEX, vertices);
+        for (int i = 1; i <= vertices.Extent(); ++i) {
+            critical.push_back(BRep_Tool::Pnt(TopoDS::Vertex(vertices(i))).Z());
+        }
+
+        if (critical.size() < 2) {
+            return;
+        }
+        std::sort(critical.begin(), critical.end());
+        std::sort(blocked.begin(), blocked.end());
+
+        // The blocked ranges end on critical heights, so each interval between two of them is
+        // either covered by a range or clear of all of them; its midpoint tells which. The
+        // midpoints ascend, so one pass over the ranges sorted by start finds every cover.
+        const double tolerance = Precision::Confusion();
+        size_t next_blocked = 0;
+        double blocked_until = -Precision::Infinite();
+        for (size_t i = 0; i + 1 < critical.size(); ++i) {
+            const double low = critical[i];
+            const double high = critical[i + 1];
+            if (high - low <= 2.0 * tolerance) {
+                continue;
+            }
+            const double middle = 0.5 * (low + high);
+            while (next_blocked < blocked.size() && blocked[next_blocked].first <= middle) {
+                blocked_until = std::max(blocked_until, blocked[next_blocked].second);
+                ++next_blocked;
+            }
+            if (blocked_until < middle) {
+                m_regions.push_back({ low, high });
+            }
+        }
+    }
+
+    bool PrismaticRegions::RegionAt(double z, size_t& region) const {
+
+        auto above = std::upper_bound(m_regions.begin(), m_regions.end(), z,
+            [](double value, const Region& r) { return value < r.z_min; });
+        if (above == m_regions.begin()) {
+            return false;
+        }
+        const Region& candidate = *(above - 1);
+        // A layer on or next to a critical height may cut a horizontal face or a vertex,
+        // so it gets its own section.
+        const double margin = Precision::Confusion();
+        if (z <= candidate.z_min + margin || z >= candidate.z_max - margin) {
+            return false;
+        }
+        region = static_cast<size_t>(above - 1 - m_regions.begin());
+        return true;
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <vector>
+
+#include <TopoDS_Shape.hxx>
+
+namespace geometry {
+
+    /**
+     * @brief Finds the Z intervals over which the horizontal sections of a shape do not change.
+     *
+     * Critical heights are the vertex heights and the Z extremes of every face and edge that
+     * is not vertical. Between two consecutive critical heights, an interval is prismatic if
+     * every face crossing it is a vertical ruled surface (a vertical plane, a cylinder with a
+     * vertical axis or an extrusion along Z) and every edge crossing it is a vertical line.
+     * All sections inside such an interval are then the same curves, so one section serves
+     * every layer in it. The regions are read-only after construction and may be queried
+     * from several threads at once.
+     */
+    class PrismaticRegions {
+    public:
+        explicit PrismaticRegions(const TopoDS_Shape& shape);
+
+        size_t RegionCount() const { return m_regions.size(); }
+
+        /**
+         * @brief Finds the prismatic interval containing z.
+         * @param region Receives the index of the interval, ascending with Z.
+         * @return false if z is not inside a prismatic interval, or too close to its ends
+         *         for the section there to be trusted.
+         */
+        bool RegionAt(double z, size_t& region) const;
+
+    private:
+        struct Region {
+            double z_min;
+            double z_max;
+        };
+
+        std::vector<Region> m_regions; // Ascending and disjoint.
+    };
+}
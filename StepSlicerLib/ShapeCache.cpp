@@ -0,0 +1,196 @@
+#include "ShapeCache.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+
+// --- OCCT Includes ---
+#include <BinTools.hxx>
+#include <Interface_Static.hxx>
+#include <STEPControl_Controller.hxx>
+#include <OSD_Directory.hxx>
+#include <OSD_Path.hxx>
+#include <OSD_Protection.hxx>
+#include <Standard_Version.hxx>
+
+namespace geometry {
+
+    namespace {
+        const char* const kIndexFileName = "index.txt";
+        const char* const kEntryExtension = ".bin";
+
+        // 64-bit FNV-1a; fast and good enough to tell STEP files apart together with their size.
+        const uint64_t kFnvOffset = 14695981039346656037ULL;
+        const uint64_t kFnvPrime = 1099511628211ULL;
+
+        uint64_t HashBytes(const char* data, size_t size, uint64_t hash) {
+            for (size_t i = 0; i < size; ++i) {
+                hash ^= static_cast<unsigned char>(data[i]);
+                hash *= kFnvPrime;
+            }
+            return hash;
+        }
+
+        uint64_t FileSize(const std::string& path) {
+            std::ifstream fs(path, std::ios::binary | std::ios::ate);
+            return fs.good() ? static_cast<uint64_t>(fs.tellg()) : 0;
+        }
+
+        std::string ToHex(uint64_t value) {
+            std::ostringstream os;
+            os << std::hex << std::setw(16) << std::setfill('0') << value;
+            return os.str();
+        }
+    }
+
+    ShapeCache::ShapeCache(const std::string& directory, uint64_t max_size_bytes, bool with_triangles)
+        : m_directory(directory), m_max_size(max_size_bytes), m_with_triangles(with_triangles) {
+
+        OSD_Directory dir(OSD_Path(TCollection_AsciiString(m_directory.c_str())));
+        if (!dir.Exists()) {
+            dir.Build(OSD_Protection());
+        }
+        LoadIndex();
+    }
+
+    std::string ShapeCache::MakeKey(const std::string& step_file_path) const {
+
+        std::ifstream fs(step_file_path, std::ios::binary);
+        if (!fs.good()) {
+            return std::string();
+        }
+
+        uint64_t content_hash = kFnvOffset;
+        uint64_t content_size = 0;
+        std::vector<char> buffer(1 << 20);
+        while (fs) {
+            fs.read(buffer.data(), buffer.size());
+            const size_t read = static_cast<size_t>(fs.gcount());
+            content_hash = HashBytes(buffer.data(), read, content_hash);
+            content_size += read;
+        }
+
+        // The static parameters only exist once the STEP controller has been initialised.
+        STEPControl_Controller::Init();
+        std::ostringstream settings;
+        settings << OCC_VERSION_COMPLETE
+                 << '|' << Interface_Static::CVal("xstep.cascade.unit")
+                 << '|' << Interface_Static::IVal("read.precision.mode")
+                 << '|' << Interface_Static::RVal("read.precision.val")
+                 << '|' << Interface_Static::IVal("read.step.product.mode")
+                 << '|' << (m_with_triangles ? "tri" : "notri");
+        const std::string settings_text = settings.str();
+        const uint64_t settings_hash = HashBytes(settings_text.data(), settings_text.size(), kFnvOffset);
+
+        return ToHex(content_hash) + "-" + ToHex(content_size) + "-" + ToHex(settings_hash);
+    }
+
+    bool ShapeCache::Find(const std::string& key, TopoDS_Shape& shape) {
+
+        auto entry = FindEntry(key);
+        if (entry == m_entries.end()) {
+            return false;
+        }
+
+        TopoDS_Shape cached;
+        if (!BinTools::Read(cached, EntryPath(key).c_str()) || cached.IsNull()) {
+            // The file vanished or is corrupt; forget about it so it gets rebuilt.
+            RemoveEntry(entry);
+            SaveIndex();
+            return false;
+        }
+
+        m_entries.splice(m_entries.begin(), m_entries, entry);
+        SaveIndex();
+        shape = cached;
+        return true;
+    }
+
+    bool ShapeCache::Store(const std::string& key, const TopoDS_Shape& shape) {
+
+        if (key.empty() || shape.IsNull()) {
+            return false;
+        }
+
+        auto existing = FindEntry(key);
+        if (existing != m_entries.end()) {
+            RemoveEntry(existing);
+        }
+
+        // Write to a temporary name first so a crash never leaves a truncated entry behind.
+        const std::string path = EntryPath(key);
+        const std::string temp_path = path + ".tmp";
+        if (!BinTools::Write(shape, temp_path.c_str(), m_with_triangles, Standard_False, BinTools_FormatVersion_CURRENT)) {
+            std::remove(temp_path.c_str());
+            return false;
+        }
+        std::remove(path.c_str());
+        if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+            std::remove(temp_path.c_str());
+            return false;
+        }
+
+        const uint64_t size = FileSize(path);
+        m_entries.push_front({ key, size });
+        m_total_size += size;
+
+        EvictToFit();
+        SaveIndex();
+        return FindEntry(key) != m_entries.end();
+    }
+
+    std::string ShapeCache::EntryPath(const std::string& key) const {
+        return m_directory + "/" + key + kEntryExtension;
+    }
+
+    std::list<ShapeCache::Entry>::iterator ShapeCache::FindEntry(const std::string& key) {
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->key == key) {
+                return it;
+            }
+        }
+        return m_entries.end();
+    }
+
+    void ShapeCache::RemoveEntry(std::list<Entry>::iterator entry) {
+        std::remove(EntryPath(entry->key).c_str());
+        m_total_size -= entry->size;
+        m_entries.erase(entry);
+    }
+
+    void ShapeCache::EvictToFit() {
+        while (m_total_size > m_max_size && !m_entries.empty()) {
+            RemoveEntry(std::prev(m_entries.end()));
+        }
+    }
+
+    void ShapeCache::LoadIndex() {
+
+        m_entries.clear();
+        m_total_size = 0;
+
+        std::ifstream index(m_directory + "/" + kIndexFileName);
+        std::string key;
+        uint64_t size;
+        while (index >> key >> size) {
+            // Drop index lines whose file has been deleted behind our back.
+            const uint64_t actual_size = FileSize(EntryPath(key));
+            if (actual_size == 0 || FindEntry(key) != m_entries.end()) {
+                continue;
+            }
+            m_entries.push_back({ key, actual_size });
+            m_total_size += actual_size;
+        }
+
+        EvictToFit();
+    }
+
+    void ShapeCache::SaveIndex() const {
+        std::ofstream index(m_directory + "/" + kIndexFileName, std::ios::trunc);
+        for (const auto& entry : m_entries) {
+            index << entry.key << ' ' << entry.size << '\n';
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <list>
+#include <string>
+
+#include <TopoDS_Shape.hxx>
+
+namespace geometry {
+
+    /**
+     * @brief Content-addressed on-disk cache of transferred STEP models.
+     *
+     * Shapes are stored in the OCCT binary BRep format (BinTools), keyed by a hash
+     * of the STEP file content and the reader settings that produced them. Loading
+     * the binary BRep skips both the STEP parse and the transfer. The cache keeps an
+     * index of its entries in least-recently-used order and evicts the oldest ones
+     * once the total size exceeds the configured cap.
+     *
+     * A single ShapeCache instance is not thread-safe, and the index is not shared
+     * safely between processes writing to the same directory at the same time.
+     */
+    class ShapeCache {
+    public:
+        /**
+         * @param directory      Folder holding the cache files; created if missing.
+         * @param max_size_bytes Total size the cache may grow to before evicting.
+         * @param with_triangles Also store triangulations attached to the shape.
+         */
+        ShapeCache(const std::string& directory, uint64_t max_size_bytes, bool with_triangles = false);
+
+        /**
+         * @brief Builds the cache key for a STEP file.
+         *
+         * The key covers the file content, its size, the OCCT version and the STEP
+         * reader parameters that influence the transferred shape.
+         * @return An empty string if the file cannot be read.
+         */
+        std::string MakeKey(const std::string& step_file_path) const;
+
+        // Loads a cached shape and marks it as most recently used.
+        bool Find(const std::string& key, TopoDS_Shape& shape);
+
+        // Stores a shape under the key, evicting old entries to honour the size cap.
+        bool Store(const std::string& key, const TopoDS_Shape& shape);
+
+        uint64_t TotalSize() const { return m_total_size; }
+        size_t EntryCount() const { return m_entries.size(); }
+
+    private:
+        struct Entry {
+            std::string key;
+            uint64_t size;
+        };
+
+        std::string EntryPath(const std::string& key) const;
+        std::list<Entry>::iterator FindEntry(const std::string& key);
+        void RemoveEntry(std::list<Entry>::iterator entry);
+        void EvictToFit();
+        void LoadIndex();
+        void SaveIndex() const;
+
+        std::string m_directory;
+        uint64_t m_max_size;
+        bool m_with_triangles;
+        std::list<Entry> m_entries; // Most recently used first.
+        uint64_t m_total_size = 0;
+    };
+}
@@ -1,94 +1,312 @@
 #include "StepSlicer.h"
 #include "GeometryContract.h"
+#include "ContourAssembler.h"
+#include "CurveEmitter.h"
+#include "AnalyticSectioner.h"
+
+#include <algorithm>
 
 // --- OCCT Includes ---
 #include <STEPControl_Reader.hxx>
 #include <gp_Pln.hxx>
 #include <BRepAlgoAPI_Section.hxx>
+#include <BRep_Builder.hxx>
+#include <TopoDS_Compound.hxx>
 #include <TopExp_Explorer.hxx>
 #include <TopoDS.hxx>
-#include <TopoDS_Edge.hxx>
-#include <BRep_Tool.hxx>
-#include <Geom_Curve.hxx>
-#include <GeomAdaptor_Curve.hxx> // ADDED: The crucial adaptor header
-#include <GCPnts_UniformDeflection.hxx>
 #include <gp_Pnt.hxx>
 #include <Bnd_Box.hxx>
 #include <BRepBndLib.hxx>
+#include <OSD_Parallel.hxx>
+#include <OSD_ThreadPool.hxx>
 
 namespace geometry {
 
+    namespace {
+        // Whether two option sets produce the same section at the same height.
+        bool SameSectionOptions(const SliceOptions& a, const SliceOptions& b) {
+            return a.use_face_index == b.use_face_index && a.analytic_faces == b.analytic_faces
+                && a.curve_emission == b.curve_emission
+                && a.discretization.chordal_deflection == b.discretization.chordal_deflection
+                && a.discretization.angular_deflection == b.discretization.angular_deflection
+                && a.discretization.min_segment_length == b.discretization.min_segment_length
+                && a.discretization.snap_resolution == b.discretization.snap_resolution
+                && a.assemble_contours == b.assemble_contours && a.contour_tolerance == b.contour_tolerance;
+        }
+
+        // Marks the layers whose section is the one of the layer below: both lie in the same
+        // prismatic region. The first layer of a region is sectioned and passes it upwards.
+        std::vector<char> ReusedLayers(const PrismaticRegions* regions, const std::vector<double>& heights) {
+            std::vector<char> reused(heights.size(), 0);
+            if (!regions) {
+                return reused;
+            }
+            size_t previous_region = 0;
+            bool previous_prismatic = false;
+            for (size_t i = 0; i < heights.size(); ++i) {
+                size_t region = 0;
+                const bool prismatic = regions->RegionAt(heights[i], region);
+                reused[i] = prismatic && previous_prismatic && region == previous_region;
+                previous_region = region;
+                previous_prismatic = prismatic;
+            }
+            return reused;
+        }
+    }
+
     StepSlicer::StepSlicer(const std::string& step_file_path)
         : m_file_path(step_file_path) {
     }
 
-    std::vector<geometry_contract::SlicedLayer> StepSlicer::Slice(double layer_height) {
+    bool StepSlicer::Load(ShapeCache* cache) {
+
+        TopoDS_Shape model;
+        const std::string cache_key = cache ? cache->MakeKey(m_file_path) : std::string();
+
+        if (cache_key.empty() || !cache->Find(cache_key, model)) {
+            STEPControl_Reader reader;
+            if (reader.ReadFile(m_file_path.c_str()) != IFSelect_RetDone) {
+                return false;
+            }
+            reader.TransferRoots();
+            model = reader.OneShape();
+
+            if (model.IsNull()) {
+                return false;
+            }
+
+            if (!cache_key.empty()) {
+                cache->Store(cache_key, model);
+            }
+        }
+
+        m_model = model;
+        m_mesh_slicer.reset();
+        m_bounding_box.SetVoid();
+        BRepBndLib::Add(m_model, m_bounding_box);
+        m_face_index.reset(new FaceZIndex(m_model));
+        m_prismatic_regions.reset(new PrismaticRegions(m_model));
+        {
+            std::lock_guard<std::mutex> lock(m_region_sections_mutex);
+            m_region_sections.clear();
+        }
+        return true;
+    }
+
+    std::vector<geometry_contract::SlicedLayer> StepSlicer::Slice(double layer_height, int thread_count) {
+        SliceOptions options;
+        options.layer_height = layer_height;
+        options.thread_count = thread_count;
+        return Slice(options);
+    }
+
+    std::vector<geometry_contract::SlicedLayer> StepSlicer::Slice(const SliceOptions& options) {
 
         std::vector<geometry_contract::SlicedLayer> all_layers;
+        Slice(options, [&all_layers](geometry_contract::SlicedLayer&& layer) {
+            all_layers.push_back(std::move(layer));
+            return true;
+        });
+        return all_layers;
+    }
+
+    bool StepSlicer::SliceFlat(const SliceOptions& options, const geometry_contract::FlatLayerSink& sink) {
+
+        geometry_contract::FlatLayer flat;
+        return Slice(options, [&](geometry_contract::SlicedLayer&& layer) {
+            geometry_contract::Flatten(layer, flat);
+            return sink(flat);
+        });
+    }
 
-        STEPControl_Reader reader;
-        if (reader.ReadFile(m_file_path.c_str()) != IFSelect_RetDone) {
-            return all_layers;
+    bool StepSlicer::Slice(const SliceOptions& options, const geometry_contract::LayerSink& sink) {
+
+        if (!IsLoaded() && !Load()) {
+            return false;
         }
-        reader.TransferRoots();
-        TopoDS_Shape model = reader.OneShape();
+        const TopoDS_Shape& model = m_model;
+        const FaceZIndex* face_index = options.use_face_index ? m_face_index.get() : nullptr;
+        const std::vector<double> heights = LayerHeights(options.layer_height);
+
+        // Empty layers never reach the sink.
+        const geometry_contract::LayerSink deliver = [&sink](geometry_contract::SlicedLayer&& layer) {
+            return layer.IsEmpty() || sink(std::move(layer));
+        };
 
-        if (model.IsNull()) {
-            return all_layers;
+        if (options.engine == SlicingEngine::MeshSweep) {
+            if (!m_mesh_slicer || m_mesh_slicer->Deflection() != options.mesh_deflection) {
+                m_mesh_slicer.reset(new MeshSlicer(model, options.mesh_deflection, options.thread_count != 1));
+            }
+            return m_mesh_slicer->Slice(heights, deliver);
         }
 
-        Bnd_Box bounding_box;
-        BRepBndLib::Add(model, bounding_box);
+        if (options.engine == SlicingEngine::Marching) {
+            // Each layer starts from the curves of the one below, so the layers run in order.
+            MarchingSlicer marcher(*m_face_index, options.curve_emission, options.discretization, options.analytic_faces);
+            for (const double z : heights) {
+                geometry_contract::SlicedLayer layer = marcher.SliceAt(z);
+                if (options.assemble_contours) {
+                    ContourAssembler assembler(options.contour_tolerance);
+                    layer.contours = assembler.Assemble(std::move(layer.contours));
+                }
+                if (!deliver(std::move(layer))) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // A reused layer is a copy of the last sectioned layer, which is always the first
+        // layer of its region and so was delivered just before.
+        const std::vector<char> reused = ReusedLayers(
+            options.reuse_prismatic_sections ? m_prismatic_regions.get() : nullptr, heights);
+        geometry_contract::SlicedLayer region_section;
+        const auto deliver_layer = [&](size_t i, geometry_contract::SlicedLayer&& layer) {
+            if (reused[i]) {
+                layer = region_section;
+                layer.ZHeight = heights[i];
+            }
+            else if (i + 1 < heights.size() && reused[i + 1]) {
+                region_section = layer;
+            }
+            return deliver(std::move(layer));
+        };
+
+        if (options.thread_count == 1 || heights.size() < 2) {
+            for (size_t i = 0; i < heights.size(); ++i) {
+                geometry_contract::SlicedLayer layer;
+                if (!reused[i]) {
+                    layer = SliceAtHeight(model, face_index, heights[i], options);
+                }
+                if (!deliver_layer(i, std::move(layer))) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Each Z plane is independent, so the threads share one window of heights at a time and
+        // write every layer to its own slot. Walking the slots afterwards restores the Z order.
+        const int nb_threads = options.thread_count > 0 ? options.thread_count : OSD_Parallel::NbLogicalProcessors();
+        const size_t window = options.layer_window > 0 ? static_cast<size_t>(options.layer_window)
+                                                       : static_cast<size_t>(2 * nb_threads);
+        std::vector<geometry_contract::SlicedLayer> slots(std::min(window, heights.size()));
+        OSD_ThreadPool pool(nb_threads);
+
+        for (size_t begin = 0; begin < heights.size(); begin += window) {
+            const size_t count = std::min(window, heights.size() - begin);
+            {
+                OSD_ThreadPool::Launcher launcher(pool, nb_threads);
+                launcher.Perform(0, static_cast<int>(count),
+                    [&](int /*thread_index*/, int i) {
+                        if (!reused[begin + i]) {
+                            slots[i] = SliceAtHeight(model, face_index, heights[begin + i], options);
+                        }
+                    });
+            }
+            for (size_t i = 0; i < count; ++i) {
+                if (!deliver_layer(begin + i, std::move(slots[i]))) {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    std::vector<double> StepSlicer::LayerHeights(double layer_height) const {
+
+        std::vector<double> heights;
+        if (m_bounding_box.IsVoid()) {
+            return heights;
+        }
         Standard_Real z_min, z_max, x_min, y_min, x_max, y_max;
-        bounding_box.Get(x_min, y_min, z_min, x_max, y_max, z_max);
+        m_bounding_box.Get(x_min, y_min, z_min, x_max, y_max, z_max);
 
+        // The heights are accumulated up front so every thread count sees exactly the same Z values.
         // A small epsilon to ensure we slice the very top layer
         for (double z = z_min; z <= z_max + 1e-9; z += layer_height) {
+            heights.push_back(z);
+        }
+        return heights;
+    }
 
-            gp_Pln slicing_plane(gp_Pnt(0, 0, z), gp_Dir(0, 0, 1));
-            BRepAlgoAPI_Section section(model, slicing_plane);
-            section.Build();
-            TopoDS_Shape result_section = section.Shape();
+    geometry_contract::SlicedLayer StepSlicer::SliceLayer(double z, const SliceOptions& options) const {
+        const FaceZIndex* face_index = options.use_face_index ? m_face_index.get() : nullptr;
+        size_t region = 0;
+        if (!options.reuse_prismatic_sections || !m_prismatic_regions || !m_prismatic_regions->RegionAt(z, region)) {
+            return SliceAtHeight(m_model, face_index, z, options);
+        }
 
-            if (result_section.IsNull()) {
-                continue;
+        {
+            std::lock_guard<std::mutex> lock(m_region_sections_mutex);
+            auto cached = m_region_sections.find(region);
+            if (cached != m_region_sections.end() && SameSectionOptions(cached->second.options, options)) {
+                geometry_contract::SlicedLayer layer = cached->second.layer;
+                layer.ZHeight = z;
+                return layer;
             }
+        }
+        // Sectioned outside the lock. Two threads starting on the same region at once both
+        // section it, which costs time but gives the same layer.
+        geometry_contract::SlicedLayer layer = SliceAtHeight(m_model, face_index, z, options);
+        std::lock_guard<std::mutex> lock(m_region_sections_mutex);
+        m_region_sections[region] = RegionSection{ options, layer };
+        return layer;
+    }
 
-            geometry_contract::SlicedLayer current_layer;
-            current_layer.ZHeight = z;
-
-            TopExp_Explorer explorer(result_section, TopAbs_EDGE);
-            while (explorer.More()) {
-                TopoDS_Edge edge = TopoDS::Edge(explorer.Current());
+    geometry_contract::SlicedLayer StepSlicer::SliceAtHeight(const TopoDS_Shape& model, const FaceZIndex* face_index,
+                                                             double z, const SliceOptions& options) {
 
-                Standard_Real first, last;
-                Handle(Geom_Curve) curve = BRep_Tool::Curve(edge, first, last);
+        geometry_contract::SlicedLayer current_layer;
+        current_layer.ZHeight = z;
 
-                if (!curve.IsNull()) {
-                    // CORRECTED: Create the adaptor for the curve
-                    GeomAdaptor_Curve adaptor(curve);
+        const CurveEmitter emitter(options.curve_emission, options.discretization);
 
-                    GCPnts_UniformDeflection discretizer;
-                    // Pass the ADAPTOR to the Initialize method
-                    discretizer.Initialize(adaptor, 0.1, first, last); // Also pass curve bounds
+        TopoDS_Shape section_input = model;
+        if (face_index && options.analytic_faces) {
+            // Analytic faces are sectioned directly, only the others are left for the boolean.
+            const AnalyticSectioner sectioner(emitter);
+            std::vector<size_t> face_indices;
+            face_index->Query(z, face_indices);
 
-                    if (discretizer.IsDone()) {
-                        geometry_contract::Contour current_contour;
-                        for (int i = 1; i <= discretizer.NbPoints(); ++i) {
-                            gp_Pnt point = discretizer.Value(i);
-                            current_contour.points.push_back({ point.X(), point.Y() });
-                        }
-                        current_layer.contours.push_back(current_contour);
+            BRep_Builder builder;
+            TopoDS_Compound remaining;
+            bool has_remaining = false;
+            for (size_t index : face_indices) {
+                const TopoDS_Face& face = face_index->Face(index);
+                if (!sectioner.Section(face, z, current_layer)) {
+                    if (!has_remaining) {
+                        builder.MakeCompound(remaining);
+                        has_remaining = true;
                     }
+                    builder.Add(remaining, face);
                 }
-                explorer.Next();
             }
+            section_input = has_remaining ? TopoDS_Shape(remaining) : TopoDS_Shape();
+        }
+        else if (face_index) {
+            section_input = face_index->FacesAt(z);
+        }
+
+        if (!section_input.IsNull()) {
+            gp_Pln slicing_plane(gp_Pnt(0, 0, z), gp_Dir(0, 0, 1));
+            BRepAlgoAPI_Section section(section_input, slicing_plane, Standard_False);
+            // The model is shared between threads, so the boolean must not touch its tolerances.
+            section.SetNonDestructive(Standard_True);
+            section.Build();
+            const TopoDS_Shape& result_section = section.Shape();
 
-            if (!current_layer.contours.empty()) {
-                all_layers.push_back(current_layer);
+            for (TopExp_Explorer explorer(result_section, TopAbs_EDGE); explorer.More(); explorer.Next()) {
+                emitter.Emit(TopoDS::Edge(explorer.Current()), current_layer);
             }
         }
 
-        return all_layers;
+        if (options.assemble_contours) {
+            ContourAssembler assembler(options.contour_tolerance);
+            current_layer.contours = assembler.Assemble(std::move(current_layer.contours));
+        }
+
+        return current_layer;
     }
-}
\ No newline at end of file
+}
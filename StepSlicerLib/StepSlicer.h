@@ -1,17 +1,148 @@
 #pragma once
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector> // We need this for the return type
 #include "GeometryContract.h" // And our contract
+#include "ShapeCache.h"
+#include "MeshSlicer.h"
+#include "MarchingSlicer.h"
+#include "CurveEmitter.h"
+#include "FaceZIndex.h"
+#include "PrismaticRegions.h"
+
+#include <TopoDS_Shape.hxx>
+#include <Bnd_Box.hxx>
 
 namespace geometry {
+
+    enum class SlicingEngine {
+        BRepSection, // One exact BRepAlgoAPI_Section per layer.
+        MeshSweep,   // Triangulate once, then sweep all layers over the mesh (see MeshSlicer).
+        Marching     // Exact sections carried from layer to layer with Newton steps (see MarchingSlicer).
+    };
+
+    struct SliceOptions {
+        double layer_height = 0.05;
+        // 1 slices serially, 0 uses every logical processor. The result is identical for every thread count.
+        int thread_count = 1;
+        // Layers sliced ahead of a streaming sink, which bounds the layers held in memory.
+        // 0 uses twice the thread count.
+        int layer_window = 0;
+        SlicingEngine engine = SlicingEngine::BRepSection;
+        // Linear deflection of the triangulation used by SlicingEngine::MeshSweep.
+        double mesh_deflection = 0.01;
+        // Join the per-edge polylines of a section into loops (see ContourAssembler).
+        bool assemble_contours = true;
+        // Maximum gap between two edge end points that are joined.
+        double contour_tolerance = 1e-3;
+        // How section edges become layer geometry. Analytic emission keeps lines, circles
+        // and ellipses exact; loops containing arcs are then only assembled between the arcs.
+        // The Marching engine applies it to the faces it sections in closed form only.
+        CurveEmission curve_emission = CurveEmission::Polyline;
+        // Accuracy of the polylines produced by the section and marching engines.
+        DiscretizationPolicy discretization;
+        // Section each layer only against the faces whose Z range spans it (see FaceZIndex).
+        bool use_face_index = true;
+        // Section planes, cylinders, cones, spheres and tori in closed form (see AnalyticSectioner)
+        // and run the boolean only on the remaining faces. Requires use_face_index.
+        bool analytic_faces = true;
+        // Section each prismatic Z interval once and hand the result to all of its layers
+        // (see PrismaticRegions). Applies to the section engine.
+        bool reuse_prismatic_sections = true;
+    };
+
     class StepSlicer {
     public:
         explicit StepSlicer(const std::string& step_file_path);
 
-        // CORRECTED: Update the signature to match the implementation
-        std::vector<geometry_contract::SlicedLayer> Slice(double layer_height);
+        /**
+         * @brief Reads the STEP file and transfers it into a shape, once.
+         *
+         * The shape and its bounding box are kept for every following Slice() call,
+         * so re-slicing with different parameters does not parse the file again.
+         * @param cache Optional on-disk cache. A hit skips the STEP parse entirely,
+         *              a miss stores the transferred shape for the next run.
+         * @return false if the file could not be read or produced no shape.
+         */
+        bool Load(ShapeCache* cache = nullptr);
+
+        bool IsLoaded() const { return !m_model.IsNull(); }
+
+        // The loaded model and its bounding box. Both are empty until Load() succeeds.
+        const TopoDS_Shape& Shape() const { return m_model; }
+        const Bnd_Box& BoundingBox() const { return m_bounding_box; }
+
+        /**
+         * @brief Slices the loaded model and streams the layers into a sink.
+         *
+         * Loads the model first if Load() has not been called yet. Each non-empty layer is
+         * handed over in ascending Z order as soon as it and every layer below it are done,
+         * so at most options.layer_window layers are in memory at once (one for MeshSweep
+         * and Marching, which run on the calling thread).
+         * Contours that could not be closed keep closed == false.
+         * @return false if the model could not be loaded or the sink stopped the slice.
+         */
+        bool Slice(const SliceOptions& options, const geometry_contract::LayerSink& sink);
+
+        /**
+         * @brief Like the LayerSink overload, but hands each layer over as a FlatLayer.
+         *
+         * One FlatLayer is reused for the whole slice, so once its buffers have grown to the
+         * largest layer no further allocation happens on the consumer side.
+         */
+        bool SliceFlat(const SliceOptions& options, const geometry_contract::FlatLayerSink& sink);
+
+        /**
+         * @brief Slices the loaded model into horizontal layers.
+         *
+         * Collects every layer of the build, see the sink overload for large jobs.
+         * Layers without any contour are left out.
+         */
+        std::vector<geometry_contract::SlicedLayer> Slice(const SliceOptions& options);
+
+        /**
+         * @brief Slices the loaded model with the exact section engine.
+         * @param layer_height Distance between two consecutive slicing planes.
+         * @param thread_count Number of threads sharing the Z planes. 1 slices serially,
+         *                     0 uses every logical processor. The result is identical
+         *                     for every thread count.
+         */
+        std::vector<geometry_contract::SlicedLayer> Slice(double layer_height, int thread_count = 1);
+
+        // The slicing heights Slice() uses for the loaded model, bottom to top.
+        std::vector<double> LayerHeights(double layer_height) const;
+
+        /**
+         * @brief Sections the loaded model at a single height with the section engine.
+         *
+         * Safe to call from several threads at once, which lets callers schedule the
+         * layers themselves. The model must already be loaded. With reuse_prismatic_sections,
+         * the first section of each prismatic interval is kept and copied for later calls
+         * inside that interval, until the model is loaded again.
+         */
+        geometry_contract::SlicedLayer SliceLayer(double z, const SliceOptions& options) const;
 
     private:
+        // Sections the model at a single Z height. Safe to call concurrently.
+        // With an index, only the faces crossing z take part in the section.
+        static geometry_contract::SlicedLayer SliceAtHeight(const TopoDS_Shape& model, const FaceZIndex* face_index,
+                                                            double z, const SliceOptions& options);
+
         std::string m_file_path;
+        TopoDS_Shape m_model;
+        Bnd_Box m_bounding_box;
+        std::unique_ptr<FaceZIndex> m_face_index; // Built once per loaded model.
+        std::unique_ptr<MeshSlicer> m_mesh_slicer; // Built on first MeshSweep slice, reused while the deflection matches.
+        std::unique_ptr<PrismaticRegions> m_prismatic_regions; // Built once per loaded model.
+
+        // Sections kept by SliceLayer, by prismatic region, with the options that produced them.
+        struct RegionSection {
+            SliceOptions options;
+            geometry_contract::SlicedLayer layer;
+        };
+        mutable std::mutex m_region_sections_mutex;
+        mutable std::map<size_t, RegionSection> m_region_sections;
     };
-}
\ No newline at end of file
+}
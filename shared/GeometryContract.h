@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <vector>
 
 namespace geometry_contract {
@@ -10,10 +13,104 @@ namespace geometry_contract {
 
 	struct Contour {
 		std::vector<Point2D> points;
+		// True if the last point closes the loop back onto the first one.
+		bool closed = false;
+	};
+
+	// A circular arc, described the way OVF VectorBlock.Arcs stores it.
+	struct Arc {
+		Point2D center;
+		Point2D start;
+		// Swept angle in degrees; positive is counter-clockwise. 360 is a full circle.
+		double angle;
+	};
+
+	// An elliptic arc, described the way OVF VectorBlock.Ellipses stores it.
+	struct EllipticArc {
+		Point2D center;
+		Point2D start;
+		// Swept parametric angle in degrees; positive is counter-clockwise.
+		double angle;
+		double major_radius;
+		double minor_radius;
+		// Angle of the major axis against the X axis, in degrees.
+		double rotation;
 	};
 
 	struct SlicedLayer {
 		double ZHeight;
 		std::vector<Contour> contours;
+		std::vector<Arc> arcs;
+		std::vector<EllipticArc> ellipses;
+
+		bool IsEmpty() const { return contours.empty() && arcs.empty() && ellipses.empty(); }
 	};
-}
\ No newline at end of file
+
+	// Consumer of finished layers, called once per layer in ascending Z order.
+	// Returning false asks the producer to stop.
+	using LayerSink = std::function<bool(SlicedLayer&& layer)>;
+
+	// A layer whose polylines share one point buffer instead of one vector per contour.
+	// The points are stored as interleaved x, y floats, the layout of the OVF packed
+	// points fields, so a contour can be copied into a LineSequence in one block.
+	struct FlatLayer {
+		double ZHeight = 0.0;
+		// x0, y0, x1, y1, ... of every contour, one contour after the other.
+		std::vector<float> xy;
+		// Contour i holds the points [contour_offsets[i], contour_offsets[i + 1]).
+		// Starts with a single 0, so there is always one more offset than contours.
+		std::vector<uint32_t> contour_offsets = std::vector<uint32_t>(1, 0);
+		// Per contour, 1 if the last point closes the loop back onto the first one.
+		std::vector<uint8_t> contour_closed;
+		std::vector<Arc> arcs;
+		std::vector<EllipticArc> ellipses;
+
+		size_t ContourCount() const { return contour_closed.size(); }
+		size_t PointCount() const { return xy.size() / 2; }
+		size_t ContourPointCount(size_t contour) const { return contour_offsets[contour + 1] - contour_offsets[contour]; }
+		// Interleaved x, y of the contour's first point; ContourPointCount() pairs follow.
+		const float* ContourPoints(size_t contour) const { return xy.data() + 2 * size_t(contour_offsets[contour]); }
+		bool IsClosed(size_t contour) const { return contour_closed[contour] != 0; }
+		bool IsEmpty() const { return contour_closed.empty() && arcs.empty() && ellipses.empty(); }
+
+		// Empties the layer but keeps the buffers, so refilling it does not allocate again.
+		void Clear() {
+			ZHeight = 0.0;
+			xy.clear();
+			contour_offsets.assign(1, 0);
+			contour_closed.clear();
+			arcs.clear();
+			ellipses.clear();
+		}
+
+		void AddContour(const Contour& contour) {
+			for (const auto& p : contour.points) {
+				xy.push_back(static_cast<float>(p.x));
+				xy.push_back(static_cast<float>(p.y));
+			}
+			contour_offsets.push_back(static_cast<uint32_t>(PointCount()));
+			contour_closed.push_back(contour.closed ? 1 : 0);
+		}
+	};
+
+	// Fills flat with the content of layer, reusing flat's buffers.
+	inline void Flatten(const SlicedLayer& layer, FlatLayer& flat) {
+		flat.Clear();
+		flat.ZHeight = layer.ZHeight;
+		size_t point_count = 0;
+		for (const auto& contour : layer.contours) {
+			point_count += contour.points.size();
+		}
+		flat.xy.reserve(2 * point_count);
+		flat.contour_offsets.reserve(layer.contours.size() + 1);
+		flat.contour_closed.reserve(layer.contours.size());
+		for (const auto& contour : layer.contours) {
+			flat.AddContour(contour);
+		}
+		flat.arcs.assign(layer.arcs.begin(), layer.arcs.end());
+		flat.ellipses.assign(layer.ellipses.begin(), layer.ellipses.end());
+	}
+
+	// Like LayerSink, but the layer is only valid during the call; the producer reuses it.
+	using FlatLayerSink = std::function<bool(const FlatLayer& layer)>;
+}